@@ -0,0 +1,234 @@
+// File: ATMBenchmark.cpp
+// Build: g++ -O2 -std=c++17 ATMBenchmark.cpp -o atm_bench -pthread
+#define ATM_NO_MAIN
+#include "ATMSimulation.cpp"
+
+#include <random>
+#include <numeric>
+
+using namespace std;
+
+enum class BenchOperation { Create, Login, Balance, Deposit, Withdraw, Transfer, History, Count };
+
+const char* BENCH_OPERATION_NAMES[] = { "create", "login", "balance", "deposit", "withdraw", "transfer", "history" };
+
+struct BenchmarkOptions {
+    size_t accounts = 10000;
+    size_t threads = 4;
+    size_t operations = 20000;
+    vector<unsigned> mix = { 1, 10, 20, 25, 15, 25, 4 };
+    Cents openingBalance = 100000;
+    unsigned seed = 2025;
+    string database = "bench_accounts.db";
+    string log = "bench_accounts.wal";
+    bool keep = false;
+};
+
+struct OperationSample {
+    uint64_t nanos;
+    uint8_t operation;
+};
+
+struct WorkerResult {
+    vector<OperationSample> samples;
+    OperationProfile profile;
+    size_t failures = 0;
+};
+
+bool parseMix(const string& text, vector<unsigned>& mix) {
+    mix.assign((size_t)BenchOperation::Count, 0);
+    stringstream ss(text);
+    string part;
+    while (getline(ss, part, ',')) {
+        size_t eq = part.find('=');
+        if (eq == string::npos) return false;
+        string name = part.substr(0, eq);
+        size_t op = 0;
+        while (op < mix.size() && name != BENCH_OPERATION_NAMES[op]) ++op;
+        if (op == mix.size()) return false;
+        mix[op] = (unsigned)stoul(part.substr(eq + 1));
+    }
+    return accumulate(mix.begin(), mix.end(), 0u) > 0;
+}
+
+bool parseOptions(int argc, char* argv[], BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto next = [&]() -> string {
+            if (i + 1 >= argc) throw runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--accounts") options.accounts = max<size_t>(2, stoul(next()));
+        else if (arg == "--threads") options.threads = max<size_t>(1, stoul(next()));
+        else if (arg == "--ops") options.operations = stoul(next());
+        else if (arg == "--seed") options.seed = (unsigned)stoul(next());
+        else if (arg == "--db") options.database = next();
+        else if (arg == "--wal") options.log = next();
+        else if (arg == "--keep") options.keep = true;
+        else if (arg == "--mix") {
+            if (!parseMix(next(), options.mix)) throw runtime_error("--mix expects name=weight pairs, e.g. deposit=50,transfer=50");
+        }
+        else {
+            cout << "Usage: atm_bench [--accounts N] [--threads T] [--ops PER_THREAD] [--seed S] [--keep]\n"
+                << "                 [--mix create=W,login=W,balance=W,deposit=W,withdraw=W,transfer=W,history=W]\n"
+                << "                 [--db FILE] [--wal FILE]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void removeBenchFiles(const BenchmarkOptions& options) {
+    for (const string& file : { options.database, options.database + ".tmp", options.database + ".history", options.log, options.log + ".old" }) {
+        remove(file.c_str());
+    }
+}
+
+string benchAccount(size_t i) {
+    return "bench" + to_string(i);
+}
+
+double percentile(const vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) return 0.0;
+    size_t index = min(sorted.size() - 1, (size_t)(fraction * (double)sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+void printLatencyRow(const string& name, vector<uint64_t>& nanos, double seconds) {
+    sort(nanos.begin(), nanos.end());
+    cout << left << setw(10) << name << right
+        << setw(10) << nanos.size()
+        << setw(12) << fixed << setprecision(0) << nanos.size() / max(seconds, 1e-12)
+        << setw(11) << setprecision(1) << percentile(nanos, 0.50)
+        << setw(11) << percentile(nanos, 0.99)
+        << setw(11) << percentile(nanos, 0.999)
+        << setw(11) << (nanos.empty() ? 0.0 : nanos.back() / 1000.0) << endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) return 2;
+    }
+    catch (const exception& ex) {
+        cerr << "Error: " << ex.what() << endl;
+        return 2;
+    }
+
+    removeBenchFiles(options);
+    try {
+        Bank bank(options.database, options.log);
+        bank.open();
+
+        auto setupStart = chrono::steady_clock::now();
+        vector<thread> pool;
+        for (size_t t = 0; t < options.threads; ++t) {
+            pool.emplace_back([&, t]() {
+                for (size_t i = options.accounts * t / options.threads; i < options.accounts * (t + 1) / options.threads; ++i) {
+                    bank.createAccount(benchAccount(i), "1234");
+                    bank.deposit(benchAccount(i), options.openingBalance);
+                }
+            });
+        }
+        for (auto& worker : pool) worker.join();
+        pool.clear();
+        double setupSeconds = chrono::duration<double>(chrono::steady_clock::now() - setupStart).count();
+
+        vector<WorkerResult> results(options.threads);
+        atomic<size_t> createdAccounts{ 0 };
+        auto start = chrono::steady_clock::now();
+        for (size_t t = 0; t < options.threads; ++t) {
+            pool.emplace_back([&, t]() {
+                WorkerResult& result = results[t];
+                result.samples.reserve(options.operations);
+                operationProfile = &result.profile;
+                mt19937_64 rng(options.seed + t * 7919);
+                discrete_distribution<int> pickOperation(options.mix.begin(), options.mix.end());
+                uniform_int_distribution<size_t> pickAccount(0, options.accounts - 1);
+                uniform_int_distribution<Cents> pickAmount(1, 5000);
+                vector<Transaction> transactions;
+                for (size_t n = 0; n < options.operations; ++n) {
+                    BenchOperation operation = (BenchOperation)pickOperation(rng);
+                    string account = benchAccount(pickAccount(rng));
+                    bool ok = true;
+                    uint64_t begin = monotonicNanos();
+                    switch (operation) {
+                    case BenchOperation::Create:
+                        ok = bank.createAccount("new" + to_string(t) + "_" + to_string(createdAccounts++), "1234") == BankStatus::Ok;
+                        break;
+                    case BenchOperation::Login:
+                        ok = bank.authenticate(account, "1234");
+                        break;
+                    case BenchOperation::Balance: {
+                        Cents balance = 0;
+                        ok = bank.balance(account, balance) == BankStatus::Ok;
+                        break;
+                    }
+                    case BenchOperation::Deposit:
+                        ok = bank.deposit(account, pickAmount(rng)) == BankStatus::Ok;
+                        break;
+                    case BenchOperation::Withdraw:
+                        ok = bank.withdraw(account, pickAmount(rng)) != BankStatus::NoSuchAccount;
+                        break;
+                    case BenchOperation::Transfer: {
+                        string to = benchAccount(pickAccount(rng));
+                        BankStatus status = bank.transfer(account, to, pickAmount(rng));
+                        ok = status == BankStatus::Ok || status == BankStatus::InsufficientFunds || status == BankStatus::SameAccount;
+                        break;
+                    }
+                    case BenchOperation::History:
+                        ok = bank.recentHistory(account, 10, transactions) == BankStatus::Ok;
+                        break;
+                    default:
+                        break;
+                    }
+                    result.samples.push_back({ monotonicNanos() - begin, (uint8_t)operation });
+                    if (!ok) ++result.failures;
+                }
+                operationProfile = nullptr;
+            });
+        }
+        for (auto& worker : pool) worker.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        vector<vector<uint64_t>> byOperation((size_t)BenchOperation::Count);
+        vector<uint64_t> all;
+        OperationProfile profile;
+        uint64_t busyNanos = 0;
+        size_t failures = 0;
+        for (const auto& result : results) {
+            for (const auto& sample : result.samples) {
+                byOperation[sample.operation].push_back(sample.nanos);
+                all.push_back(sample.nanos);
+                busyNanos += sample.nanos;
+            }
+            profile.lockNanos += result.profile.lockNanos;
+            profile.persistNanos += result.profile.persistNanos;
+            failures += result.failures;
+        }
+
+        cout << "Population: " << options.accounts << " accounts created in " << fixed << setprecision(2) << setupSeconds << "s" << endl;
+        cout << "Run: " << options.threads << " threads x " << options.operations << " operations in "
+            << setprecision(3) << seconds << "s, seed " << options.seed << endl << endl;
+        cout << left << setw(10) << "operation" << right << setw(10) << "count" << setw(12) << "ops/s"
+            << setw(11) << "p50 us" << setw(11) << "p99 us" << setw(11) << "p999 us" << setw(11) << "max us" << endl;
+        for (size_t op = 0; op < byOperation.size(); ++op) {
+            if (!byOperation[op].empty()) printLatencyRow(BENCH_OPERATION_NAMES[op], byOperation[op], seconds);
+        }
+        printLatencyRow("total", all, seconds);
+
+        double busy = max<double>((double)busyNanos, 1.0);
+        uint64_t logicNanos = busyNanos - min(busyNanos, profile.lockNanos + profile.persistNanos);
+        cout << "\nTime breakdown: persistence " << setprecision(1) << 100.0 * profile.persistNanos / busy
+            << "%, locking " << 100.0 * profile.lockNanos / busy
+            << "%, logic " << 100.0 * logicNanos / busy << "%" << endl;
+        cout << "Failed operations: " << failures << endl;
+    }
+    catch (const exception& ex) {
+        cerr << "Error: " << ex.what() << endl;
+        if (!options.keep) removeBenchFiles(options);
+        return 1;
+    }
+    if (!options.keep) removeBenchFiles(options);
+    return 0;
+}
@@ -12,12 +12,43 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <shared_mutex>
+#include <thread>
+#include <memory>
+#include <unordered_map>
+#include <cstring>
+#include <chrono>
+#include <functional>
+#include <cmath>
+#include <type_traits>
+#include <array>
+#include <string_view>
+#include <charconv>
+#include <random>
 
 #ifdef _WIN32
 #include <windows.h>
 #include <conio.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define ATM_X86_SIMD
 #endif
 
 using namespace std;
@@ -29,110 +60,1793 @@ string xorEncryptDecrypt(const string& input) {
     for (size_t i = 0; i < input.size(); ++i) {
         output[i] = input[i] ^ SECRET_KEY[i % SECRET_KEY.size()];
     }
-    return output;
-}
+    return output;
+}
+
+uint32_t crc32(const char* data, size_t size, uint32_t crc = 0) {
+    static const auto tables = []() {
+        array<array<uint32_t, 256>, 8> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (size_t s = 1; s < 8; ++s) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+        }
+        return t;
+    }();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    crc = ~crc;
+    while (size >= 8) {
+        uint32_t low = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+            ^ tables[3][p[4]] ^ tables[2][p[5]] ^ tables[1][p[6]] ^ tables[0][p[7]];
+        p += 8;
+        size -= 8;
+    }
+    while (size--) crc = tables[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+uint32_t crc32(const string& data) {
+    return crc32(data.data(), data.size());
+}
+
+class StreamCipher {
+private:
+    static const size_t LANES = 8;
+    static const size_t BLOCK_BYTES = 64;
+    static const int ROUNDS = 20;
+    uint32_t key[8] = {};
+    void (*generate)(const uint32_t* key, uint64_t nonce, uint64_t counter, unsigned char* out) = keystreamPortable;
+
+    static inline void quarterRound(uint32_t (&x)[16][LANES], int a, int b, int c, int d) {
+        for (size_t l = 0; l < LANES; ++l) {
+            x[a][l] += x[b][l]; x[d][l] ^= x[a][l]; x[d][l] = (x[d][l] << 16) | (x[d][l] >> 16);
+            x[c][l] += x[d][l]; x[b][l] ^= x[c][l]; x[b][l] = (x[b][l] << 12) | (x[b][l] >> 20);
+            x[a][l] += x[b][l]; x[d][l] ^= x[a][l]; x[d][l] = (x[d][l] << 8) | (x[d][l] >> 24);
+            x[c][l] += x[d][l]; x[b][l] ^= x[c][l]; x[b][l] = (x[b][l] << 7) | (x[b][l] >> 25);
+        }
+    }
+
+    static void keystreamPortable(const uint32_t* key, uint64_t nonce, uint64_t counter, unsigned char* out) {
+        static const uint32_t constants[4] = { 0x61707865, 0x3320646e, 0x79622d32, 0x6b206574 };
+        uint32_t input[16][LANES], x[16][LANES];
+        for (size_t l = 0; l < LANES; ++l) {
+            for (int i = 0; i < 4; ++i) input[i][l] = constants[i];
+            for (int i = 0; i < 8; ++i) input[4 + i][l] = key[i];
+            input[12][l] = (uint32_t)(counter + l);
+            input[13][l] = (uint32_t)((counter + l) >> 32);
+            input[14][l] = (uint32_t)nonce;
+            input[15][l] = (uint32_t)(nonce >> 32);
+        }
+        memcpy(x, input, sizeof(x));
+        for (int round = 0; round < ROUNDS; round += 2) {
+            quarterRound(x, 0, 4, 8, 12);
+            quarterRound(x, 1, 5, 9, 13);
+            quarterRound(x, 2, 6, 10, 14);
+            quarterRound(x, 3, 7, 11, 15);
+            quarterRound(x, 0, 5, 10, 15);
+            quarterRound(x, 1, 6, 11, 12);
+            quarterRound(x, 2, 7, 8, 13);
+            quarterRound(x, 3, 4, 9, 14);
+        }
+        for (size_t l = 0; l < LANES; ++l) {
+            for (int i = 0; i < 16; ++i) {
+                uint32_t word = x[i][l] + input[i][l];
+                memcpy(out + l * BLOCK_BYTES + i * 4, &word, sizeof(word));
+            }
+        }
+    }
+
+#ifdef ATM_X86_SIMD
+    static inline __m128i rotate128(__m128i v, int bits) {
+        return _mm_or_si128(_mm_slli_epi32(v, bits), _mm_srli_epi32(v, 32 - bits));
+    }
+
+    static inline void quarterRound128(__m128i* x, int a, int b, int c, int d) {
+        x[a] = _mm_add_epi32(x[a], x[b]); x[d] = rotate128(_mm_xor_si128(x[d], x[a]), 16);
+        x[c] = _mm_add_epi32(x[c], x[d]); x[b] = rotate128(_mm_xor_si128(x[b], x[c]), 12);
+        x[a] = _mm_add_epi32(x[a], x[b]); x[d] = rotate128(_mm_xor_si128(x[d], x[a]), 8);
+        x[c] = _mm_add_epi32(x[c], x[d]); x[b] = rotate128(_mm_xor_si128(x[b], x[c]), 7);
+    }
+
+    static void keystreamSse2(const uint32_t* key, uint64_t nonce, uint64_t counter, unsigned char* out) {
+        for (size_t half = 0; half < LANES; half += 4) {
+            __m128i input[16], x[16];
+            input[0] = _mm_set1_epi32(0x61707865);
+            input[1] = _mm_set1_epi32(0x3320646e);
+            input[2] = _mm_set1_epi32(0x79622d32);
+            input[3] = _mm_set1_epi32(0x6b206574);
+            for (int i = 0; i < 8; ++i) input[4 + i] = _mm_set1_epi32((int)key[i]);
+            uint64_t c = counter + half;
+            input[12] = _mm_setr_epi32((int)(uint32_t)c, (int)(uint32_t)(c + 1), (int)(uint32_t)(c + 2), (int)(uint32_t)(c + 3));
+            input[13] = _mm_setr_epi32((int)(uint32_t)(c >> 32), (int)(uint32_t)((c + 1) >> 32), (int)(uint32_t)((c + 2) >> 32), (int)(uint32_t)((c + 3) >> 32));
+            input[14] = _mm_set1_epi32((int)(uint32_t)nonce);
+            input[15] = _mm_set1_epi32((int)(uint32_t)(nonce >> 32));
+            for (int i = 0; i < 16; ++i) x[i] = input[i];
+            for (int round = 0; round < ROUNDS; round += 2) {
+                quarterRound128(x, 0, 4, 8, 12);
+                quarterRound128(x, 1, 5, 9, 13);
+                quarterRound128(x, 2, 6, 10, 14);
+                quarterRound128(x, 3, 7, 11, 15);
+                quarterRound128(x, 0, 5, 10, 15);
+                quarterRound128(x, 1, 6, 11, 12);
+                quarterRound128(x, 2, 7, 8, 13);
+                quarterRound128(x, 3, 4, 9, 14);
+            }
+            unsigned char* base = out + half * BLOCK_BYTES;
+            for (int g = 0; g < 16; g += 4) {
+                __m128i r0 = _mm_add_epi32(x[g], input[g]), r1 = _mm_add_epi32(x[g + 1], input[g + 1]);
+                __m128i r2 = _mm_add_epi32(x[g + 2], input[g + 2]), r3 = _mm_add_epi32(x[g + 3], input[g + 3]);
+                __m128i t0 = _mm_unpacklo_epi32(r0, r1), t1 = _mm_unpacklo_epi32(r2, r3);
+                __m128i t2 = _mm_unpackhi_epi32(r0, r1), t3 = _mm_unpackhi_epi32(r2, r3);
+                _mm_storeu_si128((__m128i*)(base + 0 * BLOCK_BYTES + g * 4), _mm_unpacklo_epi64(t0, t1));
+                _mm_storeu_si128((__m128i*)(base + 1 * BLOCK_BYTES + g * 4), _mm_unpackhi_epi64(t0, t1));
+                _mm_storeu_si128((__m128i*)(base + 2 * BLOCK_BYTES + g * 4), _mm_unpacklo_epi64(t2, t3));
+                _mm_storeu_si128((__m128i*)(base + 3 * BLOCK_BYTES + g * 4), _mm_unpackhi_epi64(t2, t3));
+            }
+        }
+    }
+
+#if defined(__GNUC__)
+    __attribute__((target("avx2"))) static inline __m256i rotate256(__m256i v, int bits) {
+        if (bits == 16) return _mm256_shuffle_epi8(v, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+            2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+        if (bits == 8) return _mm256_shuffle_epi8(v, _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+            3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14));
+        return _mm256_or_si256(_mm256_slli_epi32(v, bits), _mm256_srli_epi32(v, 32 - bits));
+    }
+
+    __attribute__((target("avx2"))) static inline void quarterRound256(__m256i* x, int a, int b, int c, int d) {
+        x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = rotate256(_mm256_xor_si256(x[d], x[a]), 16);
+        x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = rotate256(_mm256_xor_si256(x[b], x[c]), 12);
+        x[a] = _mm256_add_epi32(x[a], x[b]); x[d] = rotate256(_mm256_xor_si256(x[d], x[a]), 8);
+        x[c] = _mm256_add_epi32(x[c], x[d]); x[b] = rotate256(_mm256_xor_si256(x[b], x[c]), 7);
+    }
+
+    __attribute__((target("avx2"))) static void keystreamAvx2(const uint32_t* key, uint64_t nonce, uint64_t counter, unsigned char* out) {
+        __m256i input[16], x[16];
+        input[0] = _mm256_set1_epi32(0x61707865);
+        input[1] = _mm256_set1_epi32(0x3320646e);
+        input[2] = _mm256_set1_epi32(0x79622d32);
+        input[3] = _mm256_set1_epi32(0x6b206574);
+        for (int i = 0; i < 8; ++i) input[4 + i] = _mm256_set1_epi32((int)key[i]);
+        alignas(32) uint32_t low[LANES], high[LANES];
+        for (size_t l = 0; l < LANES; ++l) {
+            low[l] = (uint32_t)(counter + l);
+            high[l] = (uint32_t)((counter + l) >> 32);
+        }
+        input[12] = _mm256_load_si256((const __m256i*)low);
+        input[13] = _mm256_load_si256((const __m256i*)high);
+        input[14] = _mm256_set1_epi32((int)(uint32_t)nonce);
+        input[15] = _mm256_set1_epi32((int)(uint32_t)(nonce >> 32));
+        for (int i = 0; i < 16; ++i) x[i] = input[i];
+        for (int round = 0; round < ROUNDS; round += 2) {
+            quarterRound256(x, 0, 4, 8, 12);
+            quarterRound256(x, 1, 5, 9, 13);
+            quarterRound256(x, 2, 6, 10, 14);
+            quarterRound256(x, 3, 7, 11, 15);
+            quarterRound256(x, 0, 5, 10, 15);
+            quarterRound256(x, 1, 6, 11, 12);
+            quarterRound256(x, 2, 7, 8, 13);
+            quarterRound256(x, 3, 4, 9, 14);
+        }
+        for (int g = 0; g < 16; g += 8) {
+            __m256i r[8];
+            for (int i = 0; i < 8; ++i) r[i] = _mm256_add_epi32(x[g + i], input[g + i]);
+            __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]), t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+            __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]), t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+            __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]), t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+            __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]), t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+            __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+            __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+            __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+            __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+            const __m256i lanes[8] = {
+                _mm256_permute2x128_si256(u0, u4, 0x20), _mm256_permute2x128_si256(u1, u5, 0x20),
+                _mm256_permute2x128_si256(u2, u6, 0x20), _mm256_permute2x128_si256(u3, u7, 0x20),
+                _mm256_permute2x128_si256(u0, u4, 0x31), _mm256_permute2x128_si256(u1, u5, 0x31),
+                _mm256_permute2x128_si256(u2, u6, 0x31), _mm256_permute2x128_si256(u3, u7, 0x31) };
+            for (size_t l = 0; l < LANES; ++l) _mm256_storeu_si256((__m256i*)(out + l * BLOCK_BYTES + g * 4), lanes[l]);
+        }
+    }
+#endif
+#endif
+
+public:
+    explicit StreamCipher(const string& secret) {
+        unsigned char bytes[sizeof(key)];
+        for (size_t i = 0; i < sizeof(bytes); ++i) bytes[i] = secret.empty() ? 0 : (unsigned char)secret[i % secret.size()];
+        memcpy(key, bytes, sizeof(key));
+#ifdef ATM_X86_SIMD
+        generate = keystreamSse2;
+#if defined(__GNUC__)
+        if (__builtin_cpu_supports("avx2")) generate = keystreamAvx2;
+#endif
+#endif
+    }
+
+    void apply(char* data, size_t size, uint64_t nonce, uint64_t offset = 0) const {
+        alignas(64) unsigned char stream[LANES * BLOCK_BYTES];
+        uint64_t counter = offset / BLOCK_BYTES;
+        size_t skip = (size_t)(offset % BLOCK_BYTES);
+        while (size > 0) {
+            generate(key, nonce, counter, stream);
+            size_t n = min(size, sizeof(stream) - skip);
+            size_t words = n / sizeof(uint64_t);
+            for (size_t w = 0; w < words; ++w) {
+                uint64_t a, b;
+                memcpy(&a, data + w * sizeof(uint64_t), sizeof(a));
+                memcpy(&b, stream + skip + w * sizeof(uint64_t), sizeof(b));
+                a ^= b;
+                memcpy(data + w * sizeof(uint64_t), &a, sizeof(a));
+            }
+            for (size_t i = words * sizeof(uint64_t); i < n; ++i) data[i] ^= (char)stream[skip + i];
+            data += n;
+            size -= n;
+            counter += LANES;
+            skip = 0;
+        }
+    }
+};
+
+const StreamCipher& storageCipher() {
+    static const StreamCipher cipher(SECRET_KEY);
+    return cipher;
+}
+
+uint64_t logNonce(uint64_t lsn) {
+    return lsn | (1ULL << 63);
+}
+
+uint64_t databaseNonce(uint32_t salt, uint64_t block) {
+    return (uint64_t)(salt & 0x7FFFFFFFu) << 32 | block;
+}
+
+uint64_t historyNonce(uint32_t salt, uint64_t offset) {
+    return 3ULL << 62 | (uint64_t)(salt & 0xFFFFu) << 46 | (offset & ((1ULL << 46) - 1));
+}
+
+struct OperationProfile {
+    uint64_t lockNanos = 0;
+    uint64_t persistNanos = 0;
+};
+
+thread_local OperationProfile* operationProfile = nullptr;
+
+uint64_t monotonicNanos() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class ProfileScope {
+private:
+    uint64_t* target;
+    uint64_t start;
+
+public:
+    explicit ProfileScope(uint64_t OperationProfile::* field)
+        : target(operationProfile ? &(operationProfile->*field) : nullptr), start(target ? monotonicNanos() : 0) {}
+
+    ~ProfileScope() {
+        if (target) *target += monotonicNanos() - start;
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+enum class OperationKind : uint8_t { Create, Delete, Login, Balance, Deposit, Withdraw, Transfer, History, Count };
+
+const char* OPERATION_KIND_NAMES[] = { "create", "delete", "login", "balance", "deposit", "withdraw", "transfer", "history" };
+
+class LatencyHistogram {
+private:
+    static const size_t BUCKETS = 40;
+    atomic<uint64_t> buckets[BUCKETS] = {};
+    atomic<uint64_t> samples{ 0 };
+    atomic<uint64_t> totalNanos{ 0 };
+
+    static size_t bucketFor(uint64_t nanos) {
+        size_t bucket = 0;
+        for (size_t shift = 32; shift > 0; shift >>= 1) {
+            if (nanos >> shift) {
+                nanos >>= shift;
+                bucket += shift;
+            }
+        }
+        return min(BUCKETS - 1, bucket + (nanos ? 1 : 0));
+    }
+
+public:
+    void record(uint64_t nanos) {
+        buckets[bucketFor(nanos)].fetch_add(1, memory_order_relaxed);
+        samples.fetch_add(1, memory_order_relaxed);
+        totalNanos.fetch_add(nanos, memory_order_relaxed);
+    }
+
+    uint64_t count() const {
+        return samples.load(memory_order_relaxed);
+    }
+
+    double meanMicros() const {
+        uint64_t n = count();
+        return n ? totalNanos.load(memory_order_relaxed) / 1000.0 / n : 0.0;
+    }
+
+    double percentileMicros(double fraction) const {
+        uint64_t counts[BUCKETS], n = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) n += counts[b] = buckets[b].load(memory_order_relaxed);
+        if (n == 0) return 0.0;
+        uint64_t rank = (uint64_t)ceil(fraction * (double)n), seen = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen >= max<uint64_t>(rank, 1)) return b == 0 ? 0.0 : (double)(1ULL << (b - 1)) * 2 / 1000.0;
+        }
+        return (double)(1ULL << (BUCKETS - 1)) / 1000.0;
+    }
+
+    string summary() const {
+        ostringstream out;
+        out << "count=" << count() << fixed << setprecision(1) << " mean_us=" << meanMicros()
+            << " p50_us<=" << percentileMicros(0.50) << " p99_us<=" << percentileMicros(0.99) << " p999_us<=" << percentileMicros(0.999);
+        return out.str();
+    }
+};
+
+struct TraceSpan {
+    atomic<uint64_t> sequence{ 0 };
+    atomic<uint64_t> start{ 0 };
+    atomic<uint64_t> duration{ 0 };
+    atomic<uint32_t> thread{ 0 };
+    atomic<uint8_t> kind{ 0 };
+};
+
+class TraceRing {
+private:
+    unique_ptr<TraceSpan[]> spans;
+    size_t capacity = 0;
+    atomic<uint64_t> next{ 0 };
+
+public:
+    void enable(size_t size) {
+        spans = make_unique<TraceSpan[]>(size);
+        capacity = size;
+    }
+
+    bool enabled() const {
+        return capacity > 0;
+    }
+
+    void record(OperationKind kind, uint64_t start, uint64_t duration, uint32_t thread) {
+        uint64_t sequence = next.fetch_add(1, memory_order_relaxed);
+        TraceSpan& span = spans[sequence % capacity];
+        span.sequence.store(0, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        span.start.store(start, memory_order_relaxed);
+        span.duration.store(duration, memory_order_relaxed);
+        span.thread.store(thread, memory_order_relaxed);
+        span.kind.store((uint8_t)kind, memory_order_relaxed);
+        span.sequence.store(sequence + 1, memory_order_release);
+    }
+
+    vector<string> recent(size_t count) const {
+        vector<string> lines;
+        if (!enabled()) return lines;
+        uint64_t end = next.load(memory_order_acquire);
+        uint64_t begin = end - min<uint64_t>(end, min<uint64_t>(count, capacity));
+        for (uint64_t sequence = begin; sequence < end; ++sequence) {
+            const TraceSpan& span = spans[sequence % capacity];
+            if (span.sequence.load(memory_order_acquire) != sequence + 1) continue;
+            uint64_t start = span.start.load(memory_order_relaxed);
+            uint64_t duration = span.duration.load(memory_order_relaxed);
+            uint32_t worker = span.thread.load(memory_order_relaxed);
+            uint8_t kind = span.kind.load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (span.sequence.load(memory_order_relaxed) != sequence + 1 || kind >= (uint8_t)OperationKind::Count) continue;
+            lines.push_back(to_string(start) + " " + to_string(duration) + " t" + to_string(worker) + " " + OPERATION_KIND_NAMES[kind]);
+        }
+        return lines;
+    }
+};
+
+class Metrics {
+private:
+    const uint64_t startedAt = monotonicNanos();
+    atomic<uint32_t> nextThread{ 0 };
+
+public:
+    atomic<bool> enabled{ true };
+    LatencyHistogram operations[(size_t)OperationKind::Count];
+    atomic<uint64_t> failures{ 0 };
+    LatencyHistogram walSync;
+    LatencyHistogram lockWait;
+    atomic<uint64_t> lockAcquisitions{ 0 };
+    LatencyHistogram checkpoints;
+    atomic<uint64_t> walBytes{ 0 };
+    atomic<uint64_t> snapshotBytes{ 0 };
+    TraceRing trace;
+
+    bool on() const {
+        return enabled.load(memory_order_relaxed);
+    }
+
+    uint32_t threadNumber() {
+        thread_local uint32_t number = nextThread.fetch_add(1, memory_order_relaxed) + 1;
+        return number;
+    }
+
+    void finish(OperationKind kind, uint64_t start, bool ok) {
+        uint64_t duration = monotonicNanos() - start;
+        operations[(size_t)kind].record(duration);
+        if (!ok) failures.fetch_add(1, memory_order_relaxed);
+        if (trace.enabled()) trace.record(kind, start - startedAt, duration, threadNumber());
+    }
+
+    vector<string> report() const {
+        vector<string> lines;
+        lines.push_back("uptime_seconds " + to_string((monotonicNanos() - startedAt) / 1000000000ULL));
+        lines.push_back(string("metrics ") + (on() ? "enabled" : "disabled") + ", trace " + (trace.enabled() ? "enabled" : "disabled"));
+        for (size_t kind = 0; kind < (size_t)OperationKind::Count; ++kind) {
+            lines.push_back(string("op_") + OPERATION_KIND_NAMES[kind] + " " + operations[kind].summary());
+        }
+        lines.push_back("op_failures " + to_string(failures.load(memory_order_relaxed)));
+        lines.push_back("wal_sync " + walSync.summary());
+        lines.push_back("lock_acquisitions " + to_string(lockAcquisitions.load(memory_order_relaxed)));
+        lines.push_back("lock_wait " + lockWait.summary());
+        lines.push_back("checkpoint " + checkpoints.summary());
+        lines.push_back("bytes_written wal=" + to_string(walBytes.load(memory_order_relaxed))
+            + " snapshot=" + to_string(snapshotBytes.load(memory_order_relaxed)));
+        return lines;
+    }
+};
+
+Metrics metrics;
+
+class MetricsDumper {
+private:
+    string filename;
+    chrono::seconds interval;
+    thread runner;
+    mutex lock;
+    condition_variable wake;
+    bool stopping = false;
+
+    void write() {
+        string temporary = filename + ".tmp";
+        {
+            ofstream out(temporary, ios::trunc);
+            out << "timestamp " << time(nullptr) << "\n";
+            for (const auto& line : metrics.report()) out << line << "\n";
+            if (!out) return;
+        }
+        rename(temporary.c_str(), filename.c_str());
+    }
+
+    void loop() {
+        unique_lock<mutex> guard(lock);
+        while (!stopping) {
+            wake.wait_for(guard, interval);
+            write();
+        }
+    }
+
+public:
+    MetricsDumper(const string& path, int seconds) : filename(path), interval(max(1, seconds)) {
+        runner = thread(&MetricsDumper::loop, this);
+    }
+
+    ~MetricsDumper() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        runner.join();
+    }
+
+    MetricsDumper(const MetricsDumper&) = delete;
+    MetricsDumper& operator=(const MetricsDumper&) = delete;
+};
+
+class OperationSpan {
+private:
+    OperationKind kind;
+    uint64_t start;
+    bool ok = true;
+
+public:
+    explicit OperationSpan(OperationKind operation) : kind(operation), start(metrics.on() ? monotonicNanos() : 0) {}
+
+    ~OperationSpan() {
+        if (start) metrics.finish(kind, start, ok);
+    }
+
+    template <typename Status>
+    Status result(Status status, Status success = Status()) {
+        ok = status == success;
+        return status;
+    }
+
+    OperationSpan(const OperationSpan&) = delete;
+    OperationSpan& operator=(const OperationSpan&) = delete;
+};
+
+template <typename Lock, typename Mutex>
+Lock acquire(Mutex& mutex) {
+    Lock lock(mutex, try_to_lock);
+    bool measure = metrics.on();
+    if (measure) metrics.lockAcquisitions.fetch_add(1, memory_order_relaxed);
+    if (lock.owns_lock()) return lock;
+    uint64_t start = monotonicNanos();
+    lock.lock();
+    uint64_t waited = monotonicNanos() - start;
+    if (operationProfile) operationProfile->lockNanos += waited;
+    if (measure) metrics.lockWait.record(waited);
+    return lock;
+}
+
+template <typename Mutex>
+unique_lock<Mutex> lockExclusive(Mutex& mutex) {
+    return acquire<unique_lock<Mutex>>(mutex);
+}
+
+shared_lock<shared_mutex> lockShared(shared_mutex& mutex) {
+    return acquire<shared_lock<shared_mutex>>(mutex);
+}
+
+template <typename Fn>
+void parallelRanges(size_t n, size_t grain, Fn fn) {
+    size_t workers = min<size_t>(max(1u, thread::hardware_concurrency()), max<size_t>(1, n / max<size_t>(grain, 1)));
+    if (workers == 1) {
+        fn(0, n);
+        return;
+    }
+    vector<thread> pool;
+    for (size_t w = 0; w < workers; ++w) {
+        pool.emplace_back([&, w]() { fn(n * w / workers, n * (w + 1) / workers); });
+    }
+    for (auto& t : pool) t.join();
+}
+
+class MappedFile {
+private:
+    const char* view = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const string& filename) {
+#ifdef _WIN32
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (view) length = (size_t)size.QuadPart;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                view = static_cast<const char*>(p);
+                length = (size_t)st.st_size;
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (view) munmap(const_cast<char*>(view), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return view != nullptr; }
+    string_view contents() const { return string_view(view ? view : "", length); }
+};
+
+string toHex(const string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    string out;
+    out.reserve(bytes.size() * 2);
+    for (unsigned char ch : bytes) {
+        out.push_back(digits[ch >> 4]);
+        out.push_back(digits[ch & 15]);
+    }
+    return out;
+}
+
+string fromHex(const string& hex) {
+    string out;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) out.push_back((char)stoi(hex.substr(i, 2), nullptr, 16));
+    return out;
+}
+
+template <typename T>
+bool parseInteger(string_view text, T& value, int base = 10) {
+    auto parsed = from_chars(text.data(), text.data() + text.size(), value, base);
+    return !text.empty() && parsed.ec == errc() && parsed.ptr == text.data() + text.size();
+}
+
+bool parseHex(string_view hex, string& out) {
+    if (hex.size() % 2 != 0) return false;
+    out.clear();
+    out.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        uint8_t byte;
+        if (!parseInteger(hex.substr(i, 2), byte, 16)) return false;
+        out.push_back((char)byte);
+    }
+    return true;
+}
+
+bool syncFile(const string& filename) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    bool ok = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    return ok;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+#endif
+}
+
+class WriteAheadLog {
+private:
+    string filename;
+    mutex lock;
+    condition_variable flushed;
+    string pending;
+    uint64_t nextLsn = 1;
+    uint64_t durableLsn = 0;
+    atomic<uint64_t> bytesSinceCheckpoint{ 0 };
+    bool flushing = false;
+    uint64_t fileBytes = 0;
+    string failure;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+
+    void openFile() {
+#ifdef _WIN32
+        file = CreateFileA(filename.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) throw runtime_error("Cannot open " + filename);
+        LARGE_INTEGER size;
+        fileBytes = GetFileSizeEx(file, &size) ? (uint64_t)size.QuadPart : 0;
+#else
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0600);
+        if (fd < 0) throw runtime_error("Cannot open " + filename);
+        struct stat st;
+        fileBytes = fstat(fd, &st) == 0 ? (uint64_t)st.st_size : 0;
+#endif
+    }
+
+    void checkUsable() const {
+        if (!failure.empty()) throw runtime_error("Write-ahead log is unavailable after an earlier failure: " + failure);
+    }
+
+    void markFailed(const string& reason) {
+        failure = reason;
+#ifndef _WIN32
+        if (ftruncate(fd, (off_t)fileBytes) == 0) fdatasync(fd);
+#endif
+    }
+
+    void writeOrFail(const string& batch) {
+        try {
+            writeDurably(batch);
+        }
+        catch (const exception& ex) {
+            markFailed(ex.what());
+            throw;
+        }
+        fileBytes += batch.size();
+    }
+
+    void closeFile() {
+#ifdef _WIN32
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+    }
+
+    void writeDurably(const string& batch) {
+        uint64_t start = metrics.on() ? monotonicNanos() : 0;
+#ifdef _WIN32
+        DWORD written = 0;
+        if (!WriteFile(file, batch.data(), (DWORD)batch.size(), &written, nullptr) || !FlushFileBuffers(file)) {
+            throw runtime_error("Cannot write " + filename);
+        }
+#else
+        size_t done = 0;
+        while (done < batch.size()) {
+            ssize_t n = write(fd, batch.data() + done, batch.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                throw runtime_error("Cannot write " + filename);
+            }
+            done += (size_t)n;
+        }
+#ifdef __APPLE__
+        if (fsync(fd) != 0) throw runtime_error("Cannot sync " + filename);
+#else
+        if (fdatasync(fd) != 0) throw runtime_error("Cannot sync " + filename);
+#endif
+#endif
+        if (start) {
+            metrics.walSync.record(monotonicNanos() - start);
+            metrics.walBytes.fetch_add(batch.size(), memory_order_relaxed);
+        }
+    }
+
+public:
+    explicit WriteAheadLog(const string& file) : filename(file) {}
+
+    ~WriteAheadLog() {
+        closeFile();
+    }
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    const string& path() const { return filename; }
+    string retiredPath() const { return filename + ".old"; }
+
+    struct Record {
+        uint64_t lsn;
+        string body;
+        bool sealed;
+    };
+
+    enum class Ending { Complete, TornTail, Damaged };
+
+    static vector<Record> readRecords(const string& file, Ending& ending) {
+        vector<Record> records;
+        ifstream in(file, ios::binary);
+        string line;
+        ending = Ending::Complete;
+        while (getline(in, line)) {
+            size_t bar = line.rfind('|');
+            uint32_t crc = 0;
+            size_t comma = line.find(',');
+            uint64_t lsn = 0;
+            string record;
+            bool valid = bar != string::npos && line.size() - bar - 1 == 8 && parseInteger(string_view(line).substr(bar + 1), crc, 16)
+                && crc32(line.data(), bar) == crc && comma < bar && parseInteger(string_view(line).substr(0, comma), lsn);
+            bool sealed = valid && line[comma + 1] == 'E';
+            if (valid) {
+                record = line.substr(comma + 1, bar - comma - 1);
+                if (sealed) {
+                    valid = parseHex(string_view(record).substr(1), record);
+                    if (valid) storageCipher().apply(&record[0], record.size(), logNonce(lsn));
+                }
+            }
+            if (!valid) {
+                ending = in.peek() == char_traits<char>::eof() ? Ending::TornTail : Ending::Damaged;
+                break;
+            }
+            records.push_back({ lsn, record, sealed });
+        }
+        return records;
+    }
+
+    void open(uint64_t lastLsn) {
+        nextLsn = lastLsn + 1;
+        durableLsn = lastLsn;
+        failure.clear();
+        openFile();
+    }
+
+    bool failed() {
+        lock_guard<mutex> guard(lock);
+        return !failure.empty();
+    }
+
+    uint64_t append(const string& record) {
+        lock_guard<mutex> guard(lock);
+        uint64_t lsn = nextLsn++;
+        string sealed = record;
+        storageCipher().apply(&sealed[0], sealed.size(), logNonce(lsn));
+        string body = to_string(lsn) + ",E" + toHex(sealed);
+        char crc[16];
+        snprintf(crc, sizeof(crc), "|%08x\n", crc32(body));
+        pending.append(body).append(crc);
+        return lsn;
+    }
+
+    void commit(uint64_t lsn) {
+        ProfileScope persist(&OperationProfile::persistNanos);
+        unique_lock<mutex> guard(lock);
+        while (durableLsn < lsn) {
+            checkUsable();
+            if (flushing) {
+                flushed.wait(guard);
+                continue;
+            }
+            flushing = true;
+            string batch;
+            batch.swap(pending);
+            uint64_t upTo = nextLsn - 1;
+            guard.unlock();
+            try {
+                writeDurably(batch);
+            }
+            catch (const exception& ex) {
+                guard.lock();
+                markFailed(ex.what());
+                flushing = false;
+                flushed.notify_all();
+                throw;
+            }
+            guard.lock();
+            fileBytes += batch.size();
+            durableLsn = upTo;
+            bytesSinceCheckpoint += batch.size();
+            flushing = false;
+            flushed.notify_all();
+        }
+    }
+
+    uint64_t rotate() {
+        unique_lock<mutex> guard(lock);
+        flushed.wait(guard, [&]() { return !flushing; });
+        checkUsable();
+        if (!pending.empty()) writeOrFail(pending);
+        pending.clear();
+        durableLsn = nextLsn - 1;
+        if (ifstream(retiredPath()).is_open()) return durableLsn;
+        closeFile();
+        bool renamed = rename(filename.c_str(), retiredPath().c_str()) == 0;
+        openFile();
+        if (!renamed) throw runtime_error("Cannot retire " + filename);
+        bytesSinceCheckpoint = 0;
+        return durableLsn;
+    }
+
+    uint64_t bytesWritten() const {
+        return bytesSinceCheckpoint.load();
+    }
+};
+
+void clearScreen() {
+#ifdef _WIN32
+    system("cls");
+#else
+    system("clear");
+#endif
+}
+
+void pauseScreen() {
+    cout << "\nPress Enter to continue...";
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    cin.get();
+}
+
+string getHiddenInput(const string& prompt) {
+    string input;
+    char ch;
+    cout << prompt;
+#ifdef _WIN32
+    while ((ch = _getch()) != '\r') {
+        if (ch == '\b' && !input.empty()) {
+            input.pop_back();
+            cout << "\b \b";
+        }
+        else if (isdigit(ch) && input.size() < 4) {
+            input.push_back(ch);
+            cout << '*';
+        }
+    }
+#else
+    system("stty -echo");
+    getline(cin, input);
+    system("stty echo");
+    cout << string(input.size(), '*') << endl;
+#endif
+    return input;
+}
+
+void printHeader(const string& title) {
+    cout << "\033[1;36m\n====== " << title << " ======\033[0m\n";
+}
+
+void printFooter() {
+    cout << "\n\033[1;33m==============================\033[0m" << endl;
+    cout << "\033[1;35m             AZD             \033[0m" << endl;
+    cout << "\033[1;33m==============================\033[0m\n" << endl;
+}
+
+using Cents = int64_t;
+
+bool parseMoney(const string& text, Cents& cents) {
+    size_t i = 0, digits = 0, decimals = 0;
+    Cents whole = 0, fraction = 0;
+    while (i < text.size() && isdigit((unsigned char)text[i])) {
+        if (++digits > 13) return false;
+        whole = whole * 10 + (text[i++] - '0');
+    }
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        while (i < text.size() && isdigit((unsigned char)text[i]) && decimals < 2) {
+            fraction = fraction * 10 + (text[i++] - '0');
+            ++decimals;
+        }
+    }
+    if (i != text.size() || (digits == 0 && decimals == 0)) return false;
+    cents = whole * 100 + (decimals == 1 ? fraction * 10 : fraction);
+    return true;
+}
+
+bool parseStoredMoney(const string& text, Cents& cents) {
+    if (parseMoney(text, cents)) return true;
+    char* end = nullptr;
+    double value = strtod(text.c_str(), &end);
+    if (text.empty() || end != text.c_str() + text.size() || !isfinite(value) || fabs(value) > 9e15) return false;
+    cents = llround(value * 100.0);
+    return true;
+}
+
+Cents parseStoredMoney(const string& text) {
+    Cents cents;
+    if (!parseStoredMoney(text, cents)) throw runtime_error("Malformed amount " + text);
+    return cents;
+}
+
+string formatMoney(Cents cents) {
+    uint64_t magnitude = cents < 0 ? 0 - (uint64_t)cents : (uint64_t)cents;
+    string fraction = to_string(magnitude % 100);
+    return (cents < 0 ? "-" : "") + to_string(magnitude / 100) + (fraction.size() < 2 ? ".0" : ".") + fraction;
+}
+
+enum class TransactionType : uint8_t { Deposit, Withdrawal, TransferOut, TransferIn };
+
+const char* transactionTypeName(TransactionType type) {
+    switch (type) {
+    case TransactionType::Deposit: return "Deposit";
+    case TransactionType::Withdrawal: return "Withdrawal";
+    case TransactionType::TransferOut: return "Transfer Out";
+    case TransactionType::TransferIn: return "Transfer In";
+    }
+    return "Unknown";
+}
+
+bool parseTransactionType(const string& name, TransactionType& type) {
+    for (uint8_t t = 0; t <= (uint8_t)TransactionType::TransferIn; ++t) {
+        if (name == transactionTypeName((TransactionType)t)) {
+            type = (TransactionType)t;
+            return true;
+        }
+    }
+    return false;
+}
+
+const uint32_t NO_COUNTERPARTY = UINT32_MAX;
+
+struct Transaction {
+    Cents amount = 0;
+    int64_t timestamp = 0;
+    uint32_t counterparty = NO_COUNTERPARTY;
+    TransactionType type = TransactionType::Deposit;
+};
+
+static_assert(sizeof(Transaction) == 24 && is_trivially_copyable<Transaction>::value, "Transaction must stay a 24-byte POD record");
+
+const char DATABASE_MAGIC[4] = { 'A', 'T', 'D', 'B' };
+const uint32_t DATABASE_VERSION = 2;
+const size_t DATABASE_CHECKSUM_BLOCK = 1 << 22;
+
+struct DatabaseHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t lsn;
+    uint64_t nameCount;
+    uint64_t accountCount;
+    uint64_t transactionCount;
+    uint64_t namesOffset;
+    uint64_t accountsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t transactionsOffset;
+    uint64_t checksumsOffset;
+    uint32_t headerCrc;
+    uint32_t salt;
+};
+
+struct DatabaseName {
+    uint64_t offset;
+    uint32_t length;
+    uint32_t reserved;
+};
+
+struct DatabaseAccount {
+    uint32_t id;
+    uint32_t pinLength;
+    uint64_t pinOffset;
+    int64_t balance;
+    uint64_t firstTransaction;
+    uint64_t transactionCount;
+};
+
+class DatabaseView {
+private:
+    const char* base = nullptr;
+    uint32_t salt = 0;
+    bool encrypted = false;
+
+public:
+    DatabaseView() = default;
+    DatabaseView(const char* data, uint32_t cipherSalt, bool isEncrypted) : base(data), salt(cipherSalt), encrypted(isEncrypted) {}
+
+    void decrypt(uint64_t offset, size_t size, char* out) const {
+        memcpy(out, base + offset, size);
+        if (!encrypted) return;
+        uint64_t position = offset - sizeof(DatabaseHeader);
+        while (size > 0) {
+            uint64_t within = position % DATABASE_CHECKSUM_BLOCK;
+            size_t n = (size_t)min<uint64_t>(size, DATABASE_CHECKSUM_BLOCK - within);
+            storageCipher().apply(out, n, databaseNonce(salt, position / DATABASE_CHECKSUM_BLOCK), within);
+            out += n;
+            size -= n;
+            position += n;
+        }
+    }
+
+    void read(uint64_t offset, size_t count, vector<Transaction>& entries) const {
+        entries.resize(count);
+        decrypt(offset, count * sizeof(Transaction), reinterpret_cast<char*>(entries.data()));
+    }
+};
+
+class HistoryStore {
+private:
+    const string filename;
+    mutex lock;
+    fstream file;
+    uint64_t end = 0;
+    uint32_t salt = 0;
+
+public:
+    explicit HistoryStore(const string& name) : filename(name) {}
+
+    ~HistoryStore() {
+        close();
+    }
+
+    void open() {
+        lock_guard<mutex> guard(lock);
+        if (file.is_open()) return;
+        file.open(filename, ios::in | ios::out | ios::binary | ios::trunc);
+        if (!file) throw runtime_error("Cannot open history file " + filename);
+        end = 0;
+        salt = random_device{}();
+    }
+
+    void close() {
+        lock_guard<mutex> guard(lock);
+        if (!file.is_open()) return;
+        file.close();
+        remove(filename.c_str());
+    }
+
+    bool isOpen() {
+        lock_guard<mutex> guard(lock);
+        return file.is_open();
+    }
+
+    uint64_t write(const vector<Transaction>& entries) {
+        lock_guard<mutex> guard(lock);
+        uint64_t offset = end;
+        string sealed(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Transaction));
+        storageCipher().apply(&sealed[0], sealed.size(), historyNonce(salt, offset));
+        file.seekp((streamoff)offset);
+        file.write(sealed.data(), (streamsize)sealed.size());
+        if (!file) throw runtime_error("Cannot write history file " + filename);
+        end += sealed.size();
+        return offset;
+    }
+
+    void read(uint64_t offset, size_t count, vector<Transaction>& entries) {
+        lock_guard<mutex> guard(lock);
+        entries.resize(count);
+        file.seekg((streamoff)offset);
+        file.read(reinterpret_cast<char*>(entries.data()), (streamsize)(count * sizeof(Transaction)));
+        if (!file) throw runtime_error("Cannot read history file " + filename);
+        storageCipher().apply(reinterpret_cast<char*>(entries.data()), count * sizeof(Transaction), historyNonce(salt, offset));
+    }
+};
+
+class TransactionHistory {
+private:
+    static const size_t BLOCK_SIZE = 256;
+    static const size_t RESIDENT_BLOCKS = 2;
+
+    struct Block {
+        int64_t minTime = 0;
+        int64_t maxTime = 0;
+        uint64_t offset = 0;
+        size_t count = 0;
+        bool spilled = false;
+        bool mapped = false;
+        vector<Transaction> entries;
+    };
+
+    HistoryStore* store = nullptr;
+    const DatabaseView* view = nullptr;
+    vector<Block> blocks;
+    vector<int64_t> latestUpTo;
+    vector<int64_t> earliestFrom;
+    size_t total = 0;
+
+    void indexTime(int64_t timestamp) {
+        size_t last = blocks.size() - 1;
+        if (latestUpTo.size() < blocks.size()) {
+            latestUpTo.push_back(last > 0 ? max(latestUpTo[last - 1], timestamp) : timestamp);
+            earliestFrom.push_back(timestamp);
+        }
+        latestUpTo[last] = max(latestUpTo[last], timestamp);
+        for (size_t b = last + 1; b-- > 0 && earliestFrom[b] > timestamp;) earliestFrom[b] = timestamp;
+    }
+
+    const Transaction* load(const Block& block, vector<Transaction>& scratch) const {
+        if (block.mapped) {
+            view->read(block.offset, block.count, scratch);
+            return scratch.data();
+        }
+        if (!block.spilled) return block.entries.data();
+        store->read(block.offset, block.count, scratch);
+        return scratch.data();
+    }
+
+    void spill(Block& block) {
+        if (block.mapped || block.spilled) return;
+        block.offset = store->write(block.entries);
+        block.spilled = true;
+        vector<Transaction>().swap(block.entries);
+    }
+
+public:
+    void attach(HistoryStore* historyStore) {
+        store = historyStore;
+    }
+
+    size_t size() const {
+        return total;
+    }
+
+    void adopt(const DatabaseView* source, uint64_t offset, size_t count, bool keepMapped) {
+        view = source;
+        blocks.clear();
+        latestUpTo.clear();
+        earliestFrom.clear();
+        total = 0;
+        size_t mappedCount = keepMapped && count > BLOCK_SIZE ? (count - 1) / BLOCK_SIZE * BLOCK_SIZE : 0;
+        blocks.reserve((count + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        vector<Transaction> entries;
+        for (size_t begin = 0; begin < count; begin += BLOCK_SIZE) {
+            size_t n = min(BLOCK_SIZE, count - begin);
+            uint64_t blockOffset = offset + begin * sizeof(Transaction);
+            source->read(blockOffset, n, entries);
+            if (begin >= mappedCount) {
+                for (const Transaction& txn : entries) append(txn);
+                continue;
+            }
+            Block block;
+            block.mapped = true;
+            block.offset = blockOffset;
+            block.count = n;
+            block.minTime = block.maxTime = entries[0].timestamp;
+            for (const Transaction& txn : entries) {
+                block.minTime = min(block.minTime, txn.timestamp);
+                block.maxTime = max(block.maxTime, txn.timestamp);
+            }
+            int64_t earliest = block.minTime, latest = block.maxTime;
+            blocks.push_back(move(block));
+            indexTime(earliest);
+            indexTime(latest);
+            total += n;
+        }
+    }
+
+    void append(const Transaction& txn) {
+        if (blocks.empty() || blocks.back().count == BLOCK_SIZE) {
+            if (store && store->isOpen() && blocks.size() >= RESIDENT_BLOCKS) spill(blocks[blocks.size() - RESIDENT_BLOCKS]);
+            blocks.emplace_back();
+            blocks.back().minTime = blocks.back().maxTime = txn.timestamp;
+        }
+        Block& block = blocks.back();
+        block.entries.push_back(txn);
+        block.minTime = min(block.minTime, txn.timestamp);
+        block.maxTime = max(block.maxTime, txn.timestamp);
+        ++block.count;
+        ++total;
+        indexTime(txn.timestamp);
+    }
+
+    vector<Transaction> range(size_t begin, size_t count) const {
+        vector<Transaction> result, scratch;
+        if (begin >= total) return result;
+        size_t end = begin + min(count, total - begin);
+        result.reserve(end - begin);
+        for (size_t b = begin / BLOCK_SIZE; b * BLOCK_SIZE < end; ++b) {
+            const Transaction* entries = load(blocks[b], scratch);
+            size_t first = max(begin, b * BLOCK_SIZE) - b * BLOCK_SIZE;
+            size_t last = min(end, b * BLOCK_SIZE + blocks[b].count) - b * BLOCK_SIZE;
+            result.insert(result.end(), entries + first, entries + last);
+        }
+        return result;
+    }
+
+    vector<Transaction> last(size_t count) const {
+        return range(total - min(count, total), count);
+    }
+
+    vector<Transaction> between(int64_t from, int64_t to) const {
+        vector<Transaction> result, scratch;
+        size_t firstBlock = lower_bound(latestUpTo.begin(), latestUpTo.end(), from) - latestUpTo.begin();
+        size_t endBlock = upper_bound(earliestFrom.begin(), earliestFrom.end(), to) - earliestFrom.begin();
+        for (size_t b = firstBlock; b < endBlock; ++b) {
+            const Block& block = blocks[b];
+            if (block.maxTime < from || block.minTime > to) continue;
+            const Transaction* entries = load(block, scratch);
+            for (size_t i = 0; i < block.count; ++i) {
+                if (entries[i].timestamp >= from && entries[i].timestamp <= to) result.push_back(entries[i]);
+            }
+        }
+        return result;
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        vector<Transaction> scratch;
+        for (const Block& block : blocks) {
+            const Transaction* entries = load(block, scratch);
+            for (size_t i = 0; i < block.count; ++i) fn(entries[i]);
+        }
+    }
+};
+
+struct Account {
+    string username;
+    string pin;
+    uint32_t id = 0;
+    Cents balance = 0;
+    TransactionHistory history;
+    mutable mutex lock;
+};
+
+class AccountIndex {
+private:
+    static const size_t SLAB_CHUNK = 1024;
+
+    struct Slot {
+        uint64_t hash = 0;
+        Account* account = nullptr;
+    };
+
+    vector<Slot> slots;
+    size_t count = 0;
+    vector<unique_ptr<Account[]>> slab;
+    size_t slabUsed = SLAB_CHUNK;
+    vector<Account*> freeAccounts;
+    vector<Account*> sortedAccounts;
+    bool viewSorted = true;
+
+    static uint64_t hashName(const string& username) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (unsigned char ch : username) hash = (hash ^ ch) * 0x100000001b3ULL;
+        return hash ^ (hash >> 32);
+    }
+
+    static bool byName(const Account* a, const Account* b) {
+        return a->username < b->username;
+    }
+
+    size_t probe(const string& username, uint64_t hash) const {
+        size_t mask = slots.size() - 1;
+        size_t i = (size_t)hash & mask;
+        while (slots[i].account && (slots[i].hash != hash || slots[i].account->username != username)) i = (i + 1) & mask;
+        return i;
+    }
+
+    void grow(size_t capacity) {
+        size_t size = 16;
+        while (size * 7 < capacity * 10) size <<= 1;
+        if (size <= slots.size()) return;
+        vector<Slot> old(size);
+        old.swap(slots);
+        for (const Slot& slot : old) {
+            if (!slot.account) continue;
+            size_t i = (size_t)slot.hash & (slots.size() - 1);
+            while (slots[i].account) i = (i + 1) & (slots.size() - 1);
+            slots[i] = slot;
+        }
+    }
+
+    Account* allocate() {
+        if (!freeAccounts.empty()) {
+            Account* account = freeAccounts.back();
+            freeAccounts.pop_back();
+            return account;
+        }
+        if (slabUsed == SLAB_CHUNK) {
+            slab.push_back(make_unique<Account[]>(SLAB_CHUNK));
+            slabUsed = 0;
+        }
+        return &slab.back()[slabUsed++];
+    }
+
+public:
+    size_t size() const {
+        return count;
+    }
+
+    void reserve(size_t capacity) {
+        grow(capacity);
+    }
+
+    Account* find(const string& username) const {
+        if (slots.empty()) return nullptr;
+        return slots[probe(username, hashName(username))].account;
+    }
+
+    pair<Account*, bool> insert(const string& username, bool bulk = false) {
+        grow(count + 1);
+        uint64_t hash = hashName(username);
+        Slot& slot = slots[probe(username, hash)];
+        if (slot.account) return { slot.account, false };
+        Account* account = allocate();
+        account->username = username;
+        slot.hash = hash;
+        slot.account = account;
+        ++count;
+        if (bulk || !viewSorted) {
+            sortedAccounts.push_back(account);
+            viewSorted = false;
+        }
+        else {
+            sortedAccounts.insert(upper_bound(sortedAccounts.begin(), sortedAccounts.end(), account, byName), account);
+        }
+        return { account, true };
+    }
+
+    vector<Account*> allocateBulk(size_t n) {
+        vector<Account*> accounts(n);
+        for (auto& account : accounts) account = allocate();
+        return accounts;
+    }
+
+    bool link(Account* account) {
+        grow(count + 1);
+        uint64_t hash = hashName(account->username);
+        Slot& slot = slots[probe(account->username, hash)];
+        if (slot.account) return false;
+        slot.hash = hash;
+        slot.account = account;
+        ++count;
+        sortedAccounts.push_back(account);
+        viewSorted = false;
+        return true;
+    }
+
+    bool erase(const string& username) {
+        if (slots.empty()) return false;
+        size_t mask = slots.size() - 1;
+        size_t hole = probe(username, hashName(username));
+        Account* account = slots[hole].account;
+        if (!account) return false;
+        auto it = viewSorted ? lower_bound(sortedAccounts.begin(), sortedAccounts.end(), account, byName)
+            : std::find(sortedAccounts.begin(), sortedAccounts.end(), account);
+        sortedAccounts.erase(it);
+        for (size_t i = (hole + 1) & mask; slots[i].account; i = (i + 1) & mask) {
+            size_t home = (size_t)slots[i].hash & mask;
+            if (((i - home) & mask) >= ((i - hole) & mask)) {
+                slots[hole] = slots[i];
+                hole = i;
+            }
+        }
+        slots[hole] = Slot();
+        --count;
+        account->username.clear();
+        account->pin.clear();
+        account->id = 0;
+        account->balance = 0;
+        account->history = TransactionHistory();
+        freeAccounts.push_back(account);
+        return true;
+    }
+
+    void sortView() {
+        if (viewSorted) return;
+        sort(sortedAccounts.begin(), sortedAccounts.end(), byName);
+        viewSorted = true;
+    }
+
+    const vector<Account*>& sorted() const {
+        return sortedAccounts;
+    }
+};
+
+enum class BankStatus { Ok, NoSuchAccount, AccountExists, InvalidAmount, InsufficientFunds, SameAccount };
+
+struct TransferRequest {
+    string from;
+    string to;
+    Cents amount = 0;
+};
+
+string statusMessage(BankStatus status) {
+    switch (status) {
+    case BankStatus::Ok: return "OK";
+    case BankStatus::NoSuchAccount: return "Account not found";
+    case BankStatus::AccountExists: return "Username already exists";
+    case BankStatus::InvalidAmount: return "Invalid amount";
+    case BankStatus::InsufficientFunds: return "Insufficient balance";
+    case BankStatus::SameAccount: return "Cannot transfer to the same account";
+    }
+    return "Unknown error";
+}
+
+class Bank {
+private:
+    HistoryStore historyStore;
+    unique_ptr<MappedFile> database;
+    DatabaseView databaseView;
+    AccountIndex accounts;
+    vector<string> accountNames;
+    mutable shared_mutex directoryLock;
+    mutex checkpointLock;
+    const string dataFile;
+    WriteAheadLog wal;
+    const uint64_t checkpointBytes = 1 << 20;
+    const time_t checkpointInterval = 300;
+    atomic<time_t> lastCheckpoint{ time(nullptr) };
+    thread checkpointer;
+    mutex checkpointerLock;
+    condition_variable checkpointerWake;
+    bool stopping = false;
+    bool opened = false;
+
+    Account* find(const string& username) const {
+        return accounts.find(username);
+    }
+
+    Account* addAccount(const string& username, const string& pin, uint32_t id, bool bulk) {
+        Account* account = accounts.insert(username, bulk).first;
+        account->pin = pin;
+        account->id = id;
+        account->balance = 0;
+        account->history = TransactionHistory();
+        account->history.attach(&historyStore);
+        if (id >= accountNames.size()) accountNames.resize((size_t)id + 1);
+        accountNames[id] = username;
+        return account;
+    }
+
+    static size_t alignedSize(size_t size) {
+        return (size + 7) & ~(size_t)7;
+    }
+
+    string serializeAccounts(uint64_t lsn) const {
+        DatabaseHeader header{};
+        memcpy(header.magic, DATABASE_MAGIC, sizeof(header.magic));
+        header.version = DATABASE_VERSION;
+        header.salt = random_device{}();
+        header.lsn = lsn;
+        header.nameCount = accountNames.size();
+        header.accountCount = accounts.size();
+        for (const string& name : accountNames) header.stringsSize += name.size();
+        for (const Account* acc : accounts.sorted()) {
+            header.stringsSize += acc->pin.size();
+            header.transactionCount += acc->history.size();
+        }
+        header.namesOffset = sizeof(DatabaseHeader);
+        header.accountsOffset = header.namesOffset + header.nameCount * sizeof(DatabaseName);
+        header.stringsOffset = header.accountsOffset + header.accountCount * sizeof(DatabaseAccount);
+        header.transactionsOffset = alignedSize((size_t)(header.stringsOffset + header.stringsSize));
+        header.checksumsOffset = header.transactionsOffset + header.transactionCount * sizeof(Transaction);
+        size_t checksumCount = ((size_t)header.checksumsOffset - sizeof(DatabaseHeader) + DATABASE_CHECKSUM_BLOCK - 1) / DATABASE_CHECKSUM_BLOCK;
+
+        string image((size_t)header.checksumsOffset + checksumCount * sizeof(uint32_t), '\0');
+        char* names = &image[(size_t)header.namesOffset];
+        char* records = &image[(size_t)header.accountsOffset];
+        char* strings = &image[(size_t)header.stringsOffset];
+        char* transactions = &image[(size_t)header.transactionsOffset];
+        uint64_t stringOffset = 0, transactionIndex = 0;
+        auto putString = [&](const string& value) {
+            memcpy(strings + stringOffset, value.data(), value.size());
+            stringOffset += value.size();
+            return stringOffset - value.size();
+        };
+        for (size_t id = 0; id < accountNames.size(); ++id) {
+            DatabaseName entry{};
+            entry.length = (uint32_t)accountNames[id].size();
+            entry.offset = putString(accountNames[id]);
+            memcpy(names + id * sizeof(DatabaseName), &entry, sizeof(entry));
+        }
+        size_t index = 0;
+        for (const Account* account : accounts.sorted()) {
+            const Account& acc = *account;
+            DatabaseAccount record{};
+            record.id = acc.id;
+            record.pinLength = (uint32_t)acc.pin.size();
+            record.pinOffset = putString(acc.pin);
+            record.balance = acc.balance;
+            record.firstTransaction = transactionIndex;
+            record.transactionCount = acc.history.size();
+            memcpy(records + index++ * sizeof(DatabaseAccount), &record, sizeof(record));
+            acc.history.forEach([&](const Transaction& txn) {
+                memcpy(transactions + transactionIndex++ * sizeof(Transaction), &txn, sizeof(txn));
+            });
+        }
+        memcpy(&image[0], &header, sizeof(header));
+        return image;
+    }
+
+    static void sealDatabaseImage(string& image) {
+        DatabaseHeader header;
+        memcpy(&header, image.data(), sizeof(header));
+        size_t bodySize = (size_t)header.checksumsOffset - sizeof(DatabaseHeader);
+        size_t checksumCount = (bodySize + DATABASE_CHECKSUM_BLOCK - 1) / DATABASE_CHECKSUM_BLOCK;
+        char* checksums = &image[(size_t)header.checksumsOffset];
+        char* body = &image[sizeof(DatabaseHeader)];
+        parallelRanges(checksumCount, 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                size_t offset = b * DATABASE_CHECKSUM_BLOCK;
+                size_t size = min(DATABASE_CHECKSUM_BLOCK, bodySize - offset);
+                storageCipher().apply(body + offset, size, databaseNonce(header.salt, b));
+                uint32_t crc = crc32(body + offset, size);
+                memcpy(checksums + b * sizeof(uint32_t), &crc, sizeof(crc));
+            }
+        });
+        header.headerCrc = 0;
+        header.headerCrc = crc32(reinterpret_cast<const char*>(&header), sizeof(header));
+        memcpy(&image[0], &header, sizeof(header));
+    }
 
-void clearScreen() {
+    void saveAccountsToFile(string& contents) {
+        sealDatabaseImage(contents);
+        string temporary = dataFile + ".tmp";
+        ofstream out(temporary, ios::binary | ios::trunc);
+        out.write(contents.data(), (streamsize)contents.size());
+        out.close();
+        if (!out || !syncFile(temporary)) throw runtime_error("Cannot write " + temporary);
 #ifdef _WIN32
-    system("cls");
-#else
-    system("clear");
+        remove(dataFile.c_str());
 #endif
-}
+        if (rename(temporary.c_str(), dataFile.c_str()) != 0) throw runtime_error("Cannot replace " + dataFile);
+    }
 
-void pause() {
-    cout << "\nPress Enter to continue...";
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-    cin.get();
-}
+    static string transactionRecord(const string& kind, const string& username, const Transaction& txn) {
+        return kind + "," + toHex(username) + "," + formatMoney(txn.amount) + "," + to_string(txn.timestamp);
+    }
 
-string getHiddenInput(const string& prompt) {
-    string input;
-    char ch;
-    cout << prompt;
-#ifdef _WIN32
-    while ((ch = _getch()) != '\r') {
-        if (ch == '\b' && !input.empty()) {
-            input.pop_back();
-            cout << "\b \b";
+    bool applyLogRecord(const string& record, bool sealed) {
+        auto field = [&](const string& value, string& out) {
+            if (!parseHex(value, out)) return false;
+            if (!sealed) out = xorEncryptDecrypt(out);
+            return true;
+        };
+        vector<string> parts;
+        stringstream ss(record);
+        string part;
+        while (getline(ss, part, ',')) parts.push_back(part);
+        if (parts.empty()) return false;
+        string name, other;
+        if (parts[0] == "C" && (parts.size() == 3 || parts.size() == 4)) {
+            uint32_t id = (uint32_t)accountNames.size();
+            if (parts.size() == 4 && !parseInteger(parts[3], id)) return false;
+            if (!field(parts[1], name) || !field(parts[2], other)) return false;
+            addAccount(name, other, id, true);
         }
-        else if (isdigit(ch) && input.size() < 4) {
-            input.push_back(ch);
-            cout << '*';
+        else if (parts[0] == "R" && parts.size() == 2) {
+            if (!field(parts[1], name)) return false;
+            accounts.erase(name);
+        }
+        else if ((parts[0] == "D" || parts[0] == "W") && parts.size() == 4) {
+            Cents amount = 0;
+            int64_t timestamp = 0;
+            if (!field(parts[1], name) || !parseStoredMoney(parts[2], amount) || !parseInteger(parts[3], timestamp)) return false;
+            Account* account = find(name);
+            if (!account) return false;
+            bool credit = parts[0] == "D";
+            account->balance += credit ? amount : -amount;
+            account->history.append({ amount, timestamp, NO_COUNTERPARTY, credit ? TransactionType::Deposit : TransactionType::Withdrawal });
         }
+        else if (parts[0] == "X" && parts.size() == 5) {
+            Cents amount = 0;
+            int64_t timestamp = 0;
+            if (!field(parts[1], name) || !field(parts[2], other) || !parseStoredMoney(parts[3], amount) || !parseInteger(parts[4], timestamp)) return false;
+            Account* from = find(name);
+            Account* to = find(other);
+            if (!from || !to) return false;
+            from->balance -= amount;
+            from->history.append({ amount, timestamp, to->id, TransactionType::TransferOut });
+            to->balance += amount;
+            to->history.append({ amount, timestamp, from->id, TransactionType::TransferIn });
+        }
+        else {
+            return false;
+        }
+        return true;
     }
-#else
-    system("stty -echo");
-    getline(cin, input);
-    system("stty echo");
-    cout << string(input.size(), '*') << endl;
-#endif
-    return input;
-}
-
-void printHeader(const string& title) {
-    cout << "\033[1;36m\n====== " << title << " ======\033[0m\n";
-}
-
-void printFooter() {
-    cout << "\n\033[1;33m==============================\033[0m" << endl;
-    cout << "\033[1;35m             AZD             \033[0m" << endl;
-    cout << "\033[1;33m==============================\033[0m\n" << endl;
-}
 
-struct Transaction {
-    string type;
-    double amount{};
-    time_t timestamp{};
-};
+    void recoverFromLog(uint64_t snapshotLsn, bool rewrite = false) {
+        uint64_t lastLsn = snapshotLsn;
+        bool replayed = false;
+        for (const string& file : { wal.retiredPath(), wal.path() }) {
+            WriteAheadLog::Ending ending;
+            for (const auto& record : WriteAheadLog::readRecords(file, ending)) {
+                if (record.lsn <= lastLsn) continue;
+                if (!applyLogRecord(record.body, record.sealed)) {
+                    throw runtime_error(file + " record " + to_string(record.lsn) + " cannot be applied; the logs were left untouched");
+                }
+                lastLsn = record.lsn;
+                replayed = true;
+            }
+            bool live = file == wal.path();
+            if (ending == WriteAheadLog::Ending::Damaged || (ending == WriteAheadLog::Ending::TornTail && !live)) {
+                throw runtime_error(file + " is damaged after record " + to_string(lastLsn) + "; the logs were left untouched");
+            }
+            if (ending == WriteAheadLog::Ending::TornTail) {
+                cerr << "Warning: discarding an incomplete record at the end of " << file << "." << endl;
+            }
+        }
+        if (replayed || rewrite) {
+            string image = serializeAccounts(lastLsn);
+            saveAccountsToFile(image);
+        }
+        remove(wal.retiredPath().c_str());
+        remove(wal.path().c_str());
+        wal.open(lastLsn);
+    }
 
-struct Account {
-    string username;
-    string pin;
-    double balance = 0.0;
-    vector<Transaction> history;
-};
+    uint64_t loadBinaryDatabase(unique_ptr<MappedFile> file) {
+        string_view data = file->contents();
+        DatabaseHeader header;
+        if (data.size() < sizeof(header)) throw runtime_error(dataFile + " is truncated");
+        memcpy(&header, data.data(), sizeof(header));
+        uint32_t headerCrc = header.headerCrc;
+        header.headerCrc = 0;
+        if (header.version != 1 && header.version != DATABASE_VERSION) throw runtime_error("Unsupported database version " + to_string(header.version));
+        if (crc32(reinterpret_cast<const char*>(&header), sizeof(header)) != headerCrc) throw runtime_error(dataFile + " header is corrupt");
+        uint64_t bodySize = header.checksumsOffset - sizeof(DatabaseHeader);
+        uint64_t checksumCount = (bodySize + DATABASE_CHECKSUM_BLOCK - 1) / DATABASE_CHECKSUM_BLOCK;
+        if (header.namesOffset != sizeof(DatabaseHeader)
+            || header.accountsOffset != header.namesOffset + header.nameCount * sizeof(DatabaseName)
+            || header.stringsOffset != header.accountsOffset + header.accountCount * sizeof(DatabaseAccount)
+            || header.transactionsOffset != alignedSize((size_t)(header.stringsOffset + header.stringsSize))
+            || header.checksumsOffset != header.transactionsOffset + header.transactionCount * sizeof(Transaction)
+            || header.checksumsOffset + checksumCount * sizeof(uint32_t) != data.size()
+            || header.nameCount > UINT32_MAX) {
+            throw runtime_error(dataFile + " layout is corrupt");
+        }
 
-class ATM {
-private:
-    map<string, Account> accounts;
-    Account* currentUser = nullptr;
-    const string dataFile = "accounts.db";
+        atomic<bool> valid{ true };
+        const char* body = data.data() + sizeof(DatabaseHeader);
+        const char* checksums = data.data() + header.checksumsOffset;
+        parallelRanges((size_t)checksumCount, 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end && valid; ++b) {
+                size_t offset = b * DATABASE_CHECKSUM_BLOCK;
+                uint32_t expected;
+                memcpy(&expected, checksums + b * sizeof(uint32_t), sizeof(expected));
+                if (crc32(body + offset, min<size_t>(DATABASE_CHECKSUM_BLOCK, (size_t)bodySize - offset)) != expected) valid = false;
+            }
+        });
+        if (!valid) throw runtime_error(dataFile + " checksum mismatch");
 
-    string secureInput(const string& prompt) {
-        string input;
-        cout << prompt;
-        getline(cin, input);
-        return input;
-    }
+        bool encrypted = header.version >= 2;
+        databaseView = DatabaseView(data.data(), header.salt, encrypted);
+        string tables((size_t)(header.transactionsOffset - sizeof(DatabaseHeader)), '\0');
+        const size_t piece = 1 << 20;
+        parallelRanges((tables.size() + piece - 1) / piece, 1, [&](size_t begin, size_t end) {
+            for (size_t p = begin; p < end; ++p) {
+                databaseView.decrypt(sizeof(DatabaseHeader) + p * piece, min(piece, tables.size() - p * piece), &tables[p * piece]);
+            }
+        });
+        auto table = [&](uint64_t offset) { return tables.data() + (offset - sizeof(DatabaseHeader)); };
+        string_view strings(table(header.stringsOffset), (size_t)header.stringsSize);
+        auto takeString = [&](uint64_t offset, uint32_t length) {
+            if (offset > strings.size() || length > strings.size() - offset) throw runtime_error(dataFile + " string table is corrupt");
+            string value(strings.substr((size_t)offset, length));
+            return encrypted ? value : xorEncryptDecrypt(value);
+        };
+        accountNames.resize((size_t)header.nameCount);
+        for (size_t id = 0; id < accountNames.size(); ++id) {
+            DatabaseName entry;
+            memcpy(&entry, table(header.namesOffset) + id * sizeof(DatabaseName), sizeof(entry));
+            accountNames[id] = takeString(entry.offset, entry.length);
+        }
 
-    void saveAccountsToFile() {
-        ofstream out(dataFile);
-        for (const auto& pair : accounts) {
-            const Account& acc = pair.second;
-            out << xorEncryptDecrypt(acc.username) << ','
-                << xorEncryptDecrypt(acc.pin) << ','
-                << acc.balance << '\n';
-            for (const auto& txn : acc.history) {
-                out << xorEncryptDecrypt("T") << ','
-                    << xorEncryptDecrypt(txn.type) << ','
-                    << txn.amount << ',' << txn.timestamp << '\n';
+#ifdef _WIN32
+        bool keepMapped = false;
+#else
+        bool keepMapped = true;
+#endif
+        vector<Account*> loaded = accounts.allocateBulk((size_t)header.accountCount);
+        atomic<bool> consistent{ true };
+        parallelRanges(loaded.size(), 4096, [&](size_t begin, size_t end) {
+            try {
+                for (size_t i = begin; i < end; ++i) {
+                    DatabaseAccount record;
+                    memcpy(&record, table(header.accountsOffset) + i * sizeof(DatabaseAccount), sizeof(record));
+                    if (record.id >= accountNames.size() || record.firstTransaction > header.transactionCount
+                        || record.transactionCount > header.transactionCount - record.firstTransaction) {
+                        consistent = false;
+                        return;
+                    }
+                    Account* account = loaded[i];
+                    account->username = accountNames[record.id];
+                    account->pin = takeString(record.pinOffset, record.pinLength);
+                    account->id = record.id;
+                    account->balance = record.balance;
+                    account->history.attach(&historyStore);
+                    account->history.adopt(&databaseView, header.transactionsOffset + record.firstTransaction * sizeof(Transaction),
+                        (size_t)record.transactionCount, keepMapped);
+                }
             }
-            out << "#\n";
+            catch (const exception&) {
+                consistent = false;
+            }
+        });
+        if (!consistent) throw runtime_error(dataFile + " account table is corrupt");
+        accounts.reserve(loaded.size());
+        for (Account* account : loaded) {
+            if (!accounts.link(account)) throw runtime_error(dataFile + " contains duplicate account " + account->username);
         }
-        out.close();
+        if (keepMapped) database = move(file);
+        return header.lsn;
     }
 
     void loadAccountsFromFile() {
+        uint64_t snapshotLsn = 0;
+        auto file = make_unique<MappedFile>(dataFile);
+        string_view contents = file->contents();
+        if (contents.size() >= sizeof(DATABASE_MAGIC) && memcmp(contents.data(), DATABASE_MAGIC, sizeof(DATABASE_MAGIC)) == 0) {
+            snapshotLsn = loadBinaryDatabase(move(file));
+            recoverFromLog(snapshotLsn);
+            return;
+        }
+        file.reset();
         ifstream in(dataFile);
-        if (!in.is_open()) return;
+        if (!in.is_open()) {
+            recoverFromLog(snapshotLsn);
+            return;
+        }
 
         string line;
-        Account acc;
+        int version = 0;
+        auto field = [&](const string& value) { return xorEncryptDecrypt(version > 0 ? fromHex(value) : value); };
+        Account* acc = nullptr;
         while (getline(in, line)) {
             if (line == "#") {
-                accounts[acc.username] = acc;
-                acc = Account();
+                acc = nullptr;
                 continue;
             }
             stringstream ss(line);
@@ -140,36 +1854,592 @@ private:
             vector<string> parts;
             while (getline(ss, part, ',')) parts.push_back(part);
 
-            if (parts.size() == 3) {
-                acc.username = xorEncryptDecrypt(parts[0]);
-                acc.pin = xorEncryptDecrypt(parts[1]);
-                acc.balance = stod(parts[2]);
+            size_t accountFields = version >= 2 ? 4 : 3;
+            if ((parts.size() == 2 || parts.size() == 3) && parts[0] == "L") {
+                snapshotLsn = stoull(parts[1]);
+                version = parts.size() == 3 ? stoi(parts[2]) : 1;
             }
-            else if (parts.size() == 4 && xorEncryptDecrypt(parts[0]) == "T") {
+            else if (parts.size() == accountFields && !acc) {
+                uint32_t id = version >= 2 ? (uint32_t)stoul(parts[3]) : (uint32_t)accountNames.size();
+                acc = addAccount(field(parts[0]), field(parts[1]), id, true);
+                acc->balance = parseStoredMoney(parts[2]);
+            }
+            else if (parts.size() == accountFields + 1 && acc && field(parts[0]) == "T") {
                 Transaction txn;
-                txn.type = xorEncryptDecrypt(parts[1]);
-                txn.amount = stod(parts[2]);
-                txn.timestamp = stol(parts[3]);
-                acc.history.push_back(txn);
+                if (!parseTransactionType(field(parts[1]), txn.type)) continue;
+                txn.amount = parseStoredMoney(parts[2]);
+                txn.timestamp = stoll(parts[3]);
+                if (version >= 2) txn.counterparty = (uint32_t)stoul(parts[4]);
+                acc->history.append(txn);
             }
         }
         in.close();
+        recoverFromLog(snapshotLsn, true);
+    }
+
+    void checkpointLoop() {
+        unique_lock<mutex> guard(checkpointerLock);
+        while (!stopping) {
+            checkpointerWake.wait_for(guard, chrono::seconds(1));
+            if (stopping) break;
+            uint64_t pending = wal.bytesWritten();
+            if (pending >= checkpointBytes || (pending > 0 && time(nullptr) - lastCheckpoint >= checkpointInterval)) {
+                guard.unlock();
+                try {
+                    checkpoint();
+                }
+                catch (const exception& ex) {
+                    cerr << "Checkpoint failed: " << ex.what() << endl;
+                }
+                guard.lock();
+            }
+        }
+    }
+
+    BankStatus post(const string& username, Cents amount, bool credit, Cents* newBalance) {
+        if (amount <= 0) return BankStatus::InvalidAmount;
+        uint64_t lsn;
+        {
+            auto directory = lockShared(directoryLock);
+            Account* account = find(username);
+            if (!account) return BankStatus::NoSuchAccount;
+            auto guard = lockExclusive(account->lock);
+            if (!credit && amount > account->balance) return BankStatus::InsufficientFunds;
+            account->balance += credit ? amount : -amount;
+            Transaction txn{ amount, (int64_t)time(nullptr), NO_COUNTERPARTY, credit ? TransactionType::Deposit : TransactionType::Withdrawal };
+            account->history.append(txn);
+            lsn = wal.append(transactionRecord(credit ? "D" : "W", username, txn));
+            if (newBalance) *newBalance = account->balance;
+        }
+        wal.commit(lsn);
+        return BankStatus::Ok;
+    }
+
+    BankStatus applyTransfer(const TransferRequest& request, uint64_t& lsn) {
+        if (request.amount <= 0) return BankStatus::InvalidAmount;
+        auto directory = lockShared(directoryLock);
+        Account* from = find(request.from);
+        Account* to = find(request.to);
+        if (!from || !to) return BankStatus::NoSuchAccount;
+        if (from == to) return BankStatus::SameAccount;
+        bool fromFirst = less<Account*>()(from, to);
+        auto first = lockExclusive(fromFirst ? from->lock : to->lock);
+        auto second = lockExclusive(fromFirst ? to->lock : from->lock);
+        if (request.amount > from->balance) return BankStatus::InsufficientFunds;
+        int64_t now = (int64_t)time(nullptr);
+        from->balance -= request.amount;
+        from->history.append({ request.amount, now, to->id, TransactionType::TransferOut });
+        to->balance += request.amount;
+        to->history.append({ request.amount, now, from->id, TransactionType::TransferIn });
+        lsn = wal.append("X," + toHex(request.from) + "," + toHex(request.to) + ","
+            + formatMoney(request.amount) + "," + to_string(now));
+        return BankStatus::Ok;
+    }
+
+public:
+    Bank(const string& databaseFile, const string& logFile) : historyStore(databaseFile + ".history"), dataFile(databaseFile), wal(logFile) {}
+
+    ~Bank() {
+        try {
+            close();
+        }
+        catch (const exception& ex) {
+            cerr << "Final checkpoint failed: " << ex.what() << endl;
+        }
+    }
+
+    Bank(const Bank&) = delete;
+    Bank& operator=(const Bank&) = delete;
+
+    void open() {
+        historyStore.open();
+        loadAccountsFromFile();
+        accounts.sortView();
+        opened = true;
+        checkpointer = thread(&Bank::checkpointLoop, this);
+    }
+
+    void close() {
+        if (!opened) return;
+        {
+            lock_guard<mutex> guard(checkpointerLock);
+            stopping = true;
+        }
+        checkpointerWake.notify_all();
+        checkpointer.join();
+        opened = false;
+        checkpoint();
+    }
+
+    void checkpoint() {
+        lock_guard<mutex> serial(checkpointLock);
+        uint64_t start = monotonicNanos();
+        string contents;
+        {
+            auto directory = lockExclusive(directoryLock);
+            contents = serializeAccounts(wal.rotate());
+        }
+        saveAccountsToFile(contents);
+        remove(wal.retiredPath().c_str());
+        lastCheckpoint = time(nullptr);
+        if (metrics.on()) {
+            metrics.checkpoints.record(monotonicNanos() - start);
+            metrics.snapshotBytes.fetch_add(contents.size(), memory_order_relaxed);
+        }
+    }
+
+    bool hasAccount(const string& username) const {
+        auto directory = lockShared(directoryLock);
+        return find(username) != nullptr;
+    }
+
+    BankStatus createAccount(const string& username, const string& pin) {
+        OperationSpan span(OperationKind::Create);
+        uint64_t lsn;
+        {
+            auto directory = lockExclusive(directoryLock);
+            auto inserted = accounts.insert(username);
+            if (!inserted.second) return span.result(BankStatus::AccountExists);
+            uint32_t id = (uint32_t)accountNames.size();
+            Account* account = inserted.first;
+            account->pin = pin;
+            account->id = id;
+            account->history.attach(&historyStore);
+            accountNames.push_back(username);
+            lsn = wal.append("C," + toHex(username) + "," + toHex(pin) + "," + to_string(id));
+        }
+        wal.commit(lsn);
+        return BankStatus::Ok;
+    }
+
+    BankStatus deleteAccount(const string& username) {
+        OperationSpan span(OperationKind::Delete);
+        uint64_t lsn;
+        {
+            auto directory = lockExclusive(directoryLock);
+            if (!accounts.erase(username)) return span.result(BankStatus::NoSuchAccount);
+            lsn = wal.append("R," + toHex(username));
+        }
+        wal.commit(lsn);
+        return BankStatus::Ok;
+    }
+
+    bool authenticate(const string& username, const string& pin) const {
+        OperationSpan span(OperationKind::Login);
+        auto directory = lockShared(directoryLock);
+        Account* account = find(username);
+        if (!account) return span.result(false, true);
+        auto guard = lockExclusive(account->lock);
+        return span.result(account->pin == pin, true);
+    }
+
+    BankStatus deposit(const string& username, Cents amount, Cents* newBalance = nullptr) {
+        OperationSpan span(OperationKind::Deposit);
+        return span.result(post(username, amount, true, newBalance));
+    }
+
+    BankStatus withdraw(const string& username, Cents amount, Cents* newBalance = nullptr) {
+        OperationSpan span(OperationKind::Withdraw);
+        return span.result(post(username, amount, false, newBalance));
+    }
+
+    BankStatus transfer(const string& from, const string& to, Cents amount) {
+        OperationSpan span(OperationKind::Transfer);
+        uint64_t lsn = 0;
+        BankStatus status = applyTransfer({ from, to, amount }, lsn);
+        if (status == BankStatus::Ok) wal.commit(lsn);
+        return span.result(status);
+    }
+
+    vector<BankStatus> transferBatch(const vector<TransferRequest>& requests, size_t threads = 0) {
+        vector<BankStatus> results(requests.size(), BankStatus::Ok);
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        threads = max<size_t>(1, min(threads, requests.size() / 256 + 1));
+        vector<uint64_t> lastLsn(threads, 0);
+        auto work = [&](size_t t) {
+            size_t begin = requests.size() * t / threads, end = requests.size() * (t + 1) / threads;
+            for (size_t i = begin; i < end; ++i) {
+                OperationSpan span(OperationKind::Transfer);
+                uint64_t lsn = 0;
+                results[i] = span.result(applyTransfer(requests[i], lsn));
+                lastLsn[t] = max(lastLsn[t], lsn);
+            }
+        };
+        vector<thread> pool;
+        for (size_t t = 1; t < threads; ++t) pool.emplace_back(work, t);
+        work(0);
+        for (auto& worker : pool) worker.join();
+        wal.commit(*max_element(lastLsn.begin(), lastLsn.end()));
+        return results;
+    }
+
+    BankStatus balance(const string& username, Cents& amount) const {
+        OperationSpan span(OperationKind::Balance);
+        auto directory = lockShared(directoryLock);
+        Account* account = find(username);
+        if (!account) return span.result(BankStatus::NoSuchAccount);
+        auto guard = lockExclusive(account->lock);
+        amount = account->balance;
+        return BankStatus::Ok;
+    }
+
+    BankStatus recentHistory(const string& username, size_t count, vector<Transaction>& transactions) const {
+        OperationSpan span(OperationKind::History);
+        auto directory = lockShared(directoryLock);
+        Account* account = find(username);
+        if (!account) return span.result(BankStatus::NoSuchAccount);
+        auto guard = lockExclusive(account->lock);
+        transactions = account->history.last(count);
+        return BankStatus::Ok;
+    }
+
+    BankStatus historyBetween(const string& username, int64_t from, int64_t to, vector<Transaction>& transactions) const {
+        OperationSpan span(OperationKind::History);
+        auto directory = lockShared(directoryLock);
+        Account* account = find(username);
+        if (!account) return span.result(BankStatus::NoSuchAccount);
+        auto guard = lockExclusive(account->lock);
+        transactions = account->history.between(from, to);
+        return BankStatus::Ok;
+    }
+
+    BankStatus historyPage(const string& username, size_t page, size_t pageSize, vector<Transaction>& transactions, size_t& pages) const {
+        OperationSpan span(OperationKind::History);
+        auto directory = lockShared(directoryLock);
+        Account* account = find(username);
+        if (!account) return span.result(BankStatus::NoSuchAccount);
+        auto guard = lockExclusive(account->lock);
+        size_t total = account->history.size();
+        pageSize = max<size_t>(pageSize, 1);
+        pages = (total + pageSize - 1) / pageSize;
+        transactions.clear();
+        if (page < pages) {
+            size_t end = total - page * pageSize;
+            size_t begin = end > pageSize ? end - pageSize : 0;
+            transactions = account->history.range(begin, end - begin);
+        }
+        return BankStatus::Ok;
+    }
+
+    bool usable() {
+        return !wal.failed();
+    }
+
+    string accountName(uint32_t id) const {
+        auto directory = lockShared(directoryLock);
+        return id < accountNames.size() ? accountNames[id] : string();
+    }
+
+    vector<string> usernames() const {
+        auto directory = lockShared(directoryLock);
+        vector<string> names;
+        names.reserve(accounts.size());
+        for (const Account* account : accounts.sorted()) names.push_back(account->username);
+        return names;
+    }
+};
+
+#ifndef _WIN32
+atomic<bool> serverStopping{ false };
+
+void requestServerStop(int) {
+    serverStopping = true;
+}
+
+class AtmServer {
+private:
+    struct Connection {
+        int fd = -1;
+        string input;
+        string output;
+        string username;
+        bool closing = false;
+    };
+
+    struct Worker {
+        thread runner;
+        int wakeRead = -1;
+        int wakeWrite = -1;
+        mutex lock;
+        vector<int> incoming;
+    };
+
+    Bank& bank;
+    string socketPath;
+    vector<unique_ptr<Worker>> workers;
+
+    string handleCommand(Connection& connection, const string& line) {
+        istringstream in(line);
+        string command;
+        in >> command;
+        auto fail = [](const string& message) { return "ERR " + message + "\n"; };
+        if (command == "CREATE") {
+            string username, pin;
+            if (!(in >> username >> pin)) return fail("Usage: CREATE <username> <pin>");
+            BankStatus status = bank.createAccount(username, pin);
+            return status == BankStatus::Ok ? "OK\n" : fail(statusMessage(status));
+        }
+        if (command == "LOGIN") {
+            string username, pin;
+            if (!(in >> username >> pin)) return fail("Usage: LOGIN <username> <pin>");
+            if (!bank.authenticate(username, pin)) return fail("Invalid credentials");
+            connection.username = username;
+            return "OK\n";
+        }
+        if (command == "QUIT") {
+            connection.closing = true;
+            return "OK\n";
+        }
+        if (command == "STATS" || command == "TRACE") {
+            vector<string> lines;
+            if (command == "STATS") {
+                lines = metrics.report();
+            }
+            else {
+                size_t count = 100;
+                in >> count;
+                if (!metrics.trace.enabled()) return fail("Tracing is disabled");
+                lines = metrics.trace.recent(count);
+            }
+            string reply = "OK " + to_string(lines.size()) + "\n";
+            for (const auto& text : lines) reply += text + "\n";
+            return reply;
+        }
+        if (connection.username.empty()) return fail("Not logged in");
+        if (command == "BALANCE") {
+            Cents amount = 0;
+            BankStatus status = bank.balance(connection.username, amount);
+            return status == BankStatus::Ok ? "OK " + formatMoney(amount) + "\n" : fail(statusMessage(status));
+        }
+        if (command == "DEPOSIT" || command == "WITHDRAW") {
+            string text;
+            Cents amount = 0, newBalance = 0;
+            if (!(in >> text) || !parseMoney(text, amount)) return fail("Usage: " + command + " <amount>");
+            BankStatus status = command == "DEPOSIT"
+                ? bank.deposit(connection.username, amount, &newBalance)
+                : bank.withdraw(connection.username, amount, &newBalance);
+            return status == BankStatus::Ok ? "OK " + formatMoney(newBalance) + "\n" : fail(statusMessage(status));
+        }
+        if (command == "TRANSFER") {
+            string to, text;
+            Cents amount = 0;
+            if (!(in >> to >> text) || !parseMoney(text, amount)) return fail("Usage: TRANSFER <username> <amount>");
+            BankStatus status = bank.transfer(connection.username, to, amount);
+            if (status != BankStatus::Ok) return fail(statusMessage(status));
+            Cents newBalance = 0;
+            bank.balance(connection.username, newBalance);
+            return "OK " + formatMoney(newBalance) + "\n";
+        }
+        if (command == "HISTORY") {
+            vector<Transaction> transactions;
+            string mode;
+            BankStatus status;
+            if (!(in >> mode)) {
+                status = bank.recentHistory(connection.username, 50, transactions);
+            }
+            else if (mode == "PAGE") {
+                size_t page = 0, pageSize = 50, pages = 0;
+                if (!(in >> page)) return fail("Usage: HISTORY PAGE <page> [size]");
+                in >> pageSize;
+                status = bank.historyPage(connection.username, page, pageSize, transactions, pages);
+            }
+            else if (mode == "BETWEEN") {
+                long long from = 0, to = 0;
+                if (!(in >> from >> to)) return fail("Usage: HISTORY BETWEEN <from> <to>");
+                status = bank.historyBetween(connection.username, from, to, transactions);
+            }
+            else {
+                size_t count = 0;
+                istringstream number(mode);
+                if (!(number >> count)) return fail("Usage: HISTORY [count | PAGE <page> [size] | BETWEEN <from> <to>]");
+                status = bank.recentHistory(connection.username, count, transactions);
+            }
+            if (status != BankStatus::Ok) return fail(statusMessage(status));
+            string reply = "OK " + to_string(transactions.size()) + "\n";
+            for (const auto& txn : transactions) {
+                string counterparty = txn.counterparty == NO_COUNTERPARTY ? "-" : bank.accountName(txn.counterparty);
+                reply += to_string(txn.timestamp) + " " + formatMoney(txn.amount) + " " + (counterparty.empty() ? "-" : counterparty)
+                    + " " + transactionTypeName(txn.type) + "\n";
+            }
+            return reply;
+        }
+        if (command == "LOGOUT") {
+            connection.username.clear();
+            return "OK\n";
+        }
+        return fail("Unknown command");
+    }
+
+    bool readInput(Connection& connection) {
+        char buffer[16384];
+        while (true) {
+            ssize_t n = read(connection.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                connection.input.append(buffer, (size_t)n);
+                if (connection.input.size() > (1 << 20)) return false;
+                continue;
+            }
+            if (n == 0) return false;
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+    }
+
+    bool flushOutput(Connection& connection) {
+        while (!connection.output.empty()) {
+            ssize_t n = write(connection.fd, connection.output.data(), connection.output.size());
+            if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            connection.output.erase(0, (size_t)n);
+        }
+        return !connection.closing;
+    }
+
+    void serveWorker(Worker& worker) {
+        vector<Connection> connections;
+        vector<pollfd> fds;
+        while (!serverStopping) {
+            fds.clear();
+            fds.push_back({ worker.wakeRead, POLLIN, 0 });
+            for (const auto& connection : connections) {
+                fds.push_back({ connection.fd, (short)(POLLIN | (connection.output.empty() ? 0 : POLLOUT)), 0 });
+            }
+            if (poll(fds.data(), (nfds_t)fds.size(), 500) <= 0) continue;
+
+            for (size_t i = 0; i < connections.size(); ++i) {
+                Connection& connection = connections[i];
+                short events = fds[i + 1].revents;
+                if (!events) continue;
+                bool alive = !(events & (POLLERR | POLLNVAL));
+                if (alive && (events & (POLLIN | POLLHUP))) alive = readInput(connection);
+                size_t start = 0, end;
+                while ((end = connection.input.find('\n', start)) != string::npos && !connection.closing) {
+                    string line = connection.input.substr(start, end - start);
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    try {
+                        connection.output += handleCommand(connection, line);
+                    }
+                    catch (const exception& ex) {
+                        connection.output += "ERR " + string(ex.what()) + "\n";
+                        if (!bank.usable()) connection.closing = true;
+                    }
+                    start = end + 1;
+                }
+                connection.input.erase(0, start);
+                if (!flushOutput(connection) || !alive) {
+                    ::close(connection.fd);
+                    connection.fd = -1;
+                }
+            }
+            connections.erase(remove_if(connections.begin(), connections.end(),
+                [](const Connection& connection) { return connection.fd < 0; }), connections.end());
+
+            if (fds[0].revents & POLLIN) {
+                char drain[256];
+                while (read(worker.wakeRead, drain, sizeof(drain)) > 0) {}
+                lock_guard<mutex> guard(worker.lock);
+                for (int fd : worker.incoming) {
+                    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    Connection connection;
+                    connection.fd = fd;
+                    connections.push_back(move(connection));
+                }
+                worker.incoming.clear();
+            }
+        }
+        for (const auto& connection : connections) ::close(connection.fd);
+    }
+
+public:
+    AtmServer(Bank& sharedBank, const string& path, size_t workerCount) : bank(sharedBank), socketPath(path) {
+        for (size_t i = 0; i < max<size_t>(1, workerCount); ++i) workers.push_back(make_unique<Worker>());
+    }
+
+    void run() {
+        signal(SIGPIPE, SIG_IGN);
+        signal(SIGINT, requestServerStop);
+        signal(SIGTERM, requestServerStop);
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path)) throw runtime_error("Socket path is too long");
+        memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0) throw runtime_error("Cannot create socket");
+        unlink(socketPath.c_str());
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+            ::close(listener);
+            throw runtime_error("Cannot listen on " + socketPath);
+        }
+
+        for (auto& worker : workers) {
+            int wake[2];
+            if (pipe(wake) != 0) throw runtime_error("Cannot create wake pipe");
+            fcntl(wake[0], F_SETFL, fcntl(wake[0], F_GETFL) | O_NONBLOCK);
+            fcntl(wake[1], F_SETFL, fcntl(wake[1], F_GETFL) | O_NONBLOCK);
+            worker->wakeRead = wake[0];
+            worker->wakeWrite = wake[1];
+            Worker* target = worker.get();
+            worker->runner = thread([this, target]() { serveWorker(*target); });
+        }
+        cout << "ATM server listening on " << socketPath << " with " << workers.size() << " workers" << endl;
+
+        size_t next = 0;
+        while (!serverStopping) {
+            pollfd ready{ listener, POLLIN, 0 };
+            if (poll(&ready, 1, 500) <= 0) continue;
+            int client = accept(listener, nullptr, nullptr);
+            if (client < 0) continue;
+            Worker& worker = *workers[next++ % workers.size()];
+            {
+                lock_guard<mutex> guard(worker.lock);
+                worker.incoming.push_back(client);
+            }
+            char wake = 1;
+            ssize_t signalled = write(worker.wakeWrite, &wake, 1);
+            (void)signalled;
+        }
+
+        ::close(listener);
+        unlink(socketPath.c_str());
+        for (auto& worker : workers) {
+            worker->runner.join();
+            ::close(worker->wakeRead);
+            ::close(worker->wakeWrite);
+            for (int fd : worker->incoming) ::close(fd);
+        }
+        cout << "ATM server stopped" << endl;
+    }
+};
+#endif
+
+class ATM {
+private:
+    Bank& bank;
+    string currentUser;
+
+    string secureInput(const string& prompt) {
+        string input;
+        cout << prompt;
+        getline(cin, input);
+        return input;
     }
 
     void createAccount() {
         clearScreen();
         printHeader("Create New Account");
         string username = secureInput("Enter username: ");
-        if (accounts.count(username)) {
+        if (bank.hasAccount(username)) {
             cout << "\n\033[1;31mUsername already exists.\033[0m\n";
-            pause();
+            pauseScreen();
             return;
         }
         string pin = getHiddenInput("Set a 4-digit PIN: ");
-        accounts[username] = { username, pin, 0.0, {} };
-        cout << "\n\033[1;32mAccount created successfully!\033[0m\n";
-        saveAccountsToFile();
-        pause();
+        if (bank.createAccount(username, pin) == BankStatus::Ok) {
+            cout << "\n\033[1;32mAccount created successfully!\033[0m\n";
+        }
+        else {
+            cout << "\n\033[1;31mUsername already exists.\033[0m\n";
+        }
+        pauseScreen();
     }
 
     void login() {
@@ -177,151 +2447,277 @@ private:
         printHeader("User Login");
         string username = secureInput("Enter username: ");
         string pin = getHiddenInput("Enter PIN: ");
-        if (accounts.count(username) && accounts[username].pin == pin) {
-            currentUser = &accounts[username];
+        if (bank.authenticate(username, pin)) {
+            currentUser = username;
             cout << "\n\033[1;32mLogin successful!\033[0m\n";
         }
         else {
             cout << "\n\033[1;31mInvalid credentials.\033[0m\n";
         }
-        pause();
+        pauseScreen();
     }
 
     void logout() {
-        currentUser = nullptr;
+        currentUser.clear();
     }
 
     void checkBalance() {
         clearScreen();
         printHeader("Balance Inquiry");
-        cout << "Current Balance: $" << fixed << setprecision(2) << currentUser->balance << endl;
-        pause();
+        Cents amount = 0;
+        if (bank.balance(currentUser, amount) == BankStatus::Ok) {
+            cout << "Current Balance: $" << formatMoney(amount) << endl;
+        }
+        else {
+            cout << "\n\033[1;31mAccount not found.\033[0m\n";
+            logout();
+        }
+        pauseScreen();
     }
 
     void deposit() {
         clearScreen();
         printHeader("Deposit Money");
-        double amount;
+        Cents amount = 0;
         cout << "Enter amount to deposit: $";
-        cin >> amount;
+        string text;
+        cin >> text;
         cin.ignore();
-        if (amount > 0) {
-            currentUser->balance += amount;
-            currentUser->history.push_back({ "Deposit", amount, time(nullptr) });
+        if (parseMoney(text, amount) && bank.deposit(currentUser, amount) == BankStatus::Ok) {
             cout << "\n\033[1;32mDeposit successful!\033[0m\n";
-            saveAccountsToFile();
         }
         else {
             cout << "\n\033[1;31mInvalid amount.\033[0m\n";
         }
-        pause();
+        pauseScreen();
     }
 
     void withdraw() {
         clearScreen();
         printHeader("Withdraw Money");
-        double amount;
+        Cents amount = 0;
         cout << "Enter amount to withdraw: $";
-        cin >> amount;
+        string text;
+        cin >> text;
         cin.ignore();
-        if (amount > 0 && amount <= currentUser->balance) {
-            currentUser->balance -= amount;
-            currentUser->history.push_back({ "Withdrawal", amount, time(nullptr) });
+        if (parseMoney(text, amount) && bank.withdraw(currentUser, amount) == BankStatus::Ok) {
             cout << "\n\033[1;32mWithdrawal successful!\033[0m\n";
-            saveAccountsToFile();
         }
         else {
             cout << "\n\033[1;31mInsufficient balance or invalid amount.\033[0m\n";
         }
-        pause();
+        pauseScreen();
     }
 
-    void showTransactionHistory() {
+    void transfer() {
         clearScreen();
-        printHeader("Transaction History");
-        if (currentUser->history.empty()) {
-            cout << "No transactions to display.\n";
+        printHeader("Transfer Money");
+        string to = secureInput("Enter recipient username: ");
+        Cents amount = 0;
+        cout << "Enter amount to transfer: $";
+        string text;
+        cin >> text;
+        cin.ignore();
+        BankStatus status = parseMoney(text, amount) ? bank.transfer(currentUser, to, amount) : BankStatus::InvalidAmount;
+        if (status == BankStatus::Ok) {
+            cout << "\n\033[1;32mTransfer successful!\033[0m\n";
         }
         else {
-            for (const auto& txn : currentUser->history) {
-                cout << txn.type << " of $" << fixed << setprecision(2) << txn.amount
-                    << " on " << ctime(&txn.timestamp);
+            cout << "\n\033[1;31m" << statusMessage(status) << ".\033[0m\n";
+        }
+        pauseScreen();
+    }
+
+    void showTransactionHistory() {
+        const size_t pageSize = 10;
+        size_t page = 0;
+        while (true) {
+            clearScreen();
+            printHeader("Transaction History");
+            vector<Transaction> transactions;
+            size_t pages = 0;
+            bank.historyPage(currentUser, page, pageSize, transactions, pages);
+            if (transactions.empty()) {
+                cout << "No transactions to display.\n";
+                pauseScreen();
+                return;
+            }
+            for (auto it = transactions.rbegin(); it != transactions.rend(); ++it) {
+                time_t when = (time_t)it->timestamp;
+                cout << transactionTypeName(it->type) << " of $" << formatMoney(it->amount);
+                if (it->type == TransactionType::TransferOut) cout << " to " << bank.accountName(it->counterparty);
+                if (it->type == TransactionType::TransferIn) cout << " from " << bank.accountName(it->counterparty);
+                cout << " on " << ctime(&when);
             }
+            cout << "\nPage " << page + 1 << " of " << pages << "  [N]ext older, [P]revious newer, [Q]uit: ";
+            string choice;
+            getline(cin, choice);
+            if ((choice == "n" || choice == "N") && page + 1 < pages) ++page;
+            else if ((choice == "p" || choice == "P") && page > 0) --page;
+            else if (choice != "n" && choice != "N" && choice != "p" && choice != "P") return;
         }
-        pause();
     }
 
     void userMenu() {
         int choice = 0;
-        while (currentUser) {
+        while (!currentUser.empty()) {
             clearScreen();
-            printHeader("Welcome, " + currentUser->username);
-            cout << "1. Check Balance\n2. Deposit\n3. Withdraw\n4. Transaction History\n5. Logout\n\nEnter choice: ";
+            printHeader("Welcome, " + currentUser);
+            cout << "1. Check Balance\n2. Deposit\n3. Withdraw\n4. Transfer\n5. Transaction History\n6. Logout\n\nEnter choice: ";
             cin >> choice;
             cin.ignore();
             switch (choice) {
             case 1: checkBalance(); break;
             case 2: deposit(); break;
             case 3: withdraw(); break;
-            case 4: showTransactionHistory(); break;
-            case 5: logout(); break;
-            default: cout << "\n\033[1;31mInvalid choice.\033[0m\n"; pause(); break;
+            case 4: transfer(); break;
+            case 5: showTransactionHistory(); break;
+            case 6: logout(); break;
+            default: cout << "\n\033[1;31mInvalid choice.\033[0m\n"; pauseScreen(); break;
             }
         }
     }
 
 public:
+    explicit ATM(Bank& sharedBank) : bank(sharedBank) {}
+
     void viewAllUsers() {
         clearScreen();
         printHeader("Registered Users");
-        if (accounts.empty()) {
+        vector<string> names = bank.usernames();
+        if (names.empty()) {
             cout << "No registered users found.\n";
         }
         else {
-            for (const auto& pair : accounts) {
-                cout << "- " << pair.first << endl;
+            for (const auto& name : names) {
+                cout << "- " << name << endl;
             }
         }
-        pause();
+        pauseScreen();
     }
 
     void deleteUser() {
         clearScreen();
         printHeader("Delete User Account");
         string username = secureInput("Enter username to delete: ");
-        if (accounts.erase(username)) {
+        if (bank.deleteAccount(username) == BankStatus::Ok) {
             cout << "\n\033[1;32mUser deleted successfully!\033[0m\n";
-            saveAccountsToFile();
         }
         else {
             cout << "\n\033[1;31mUser not found.\033[0m\n";
         }
-        pause();
+        pauseScreen();
+    }
+
+    void showStatistics() {
+        clearScreen();
+        printHeader("Service Statistics");
+        for (const auto& line : metrics.report()) cout << line << endl;
+        pauseScreen();
     }
 
     void run() {
-        loadAccountsFromFile();
         int option;
         while (true) {
             clearScreen();
             printHeader("ATM Simulation");
-            cout << "1. Create Account\n2. Login\n3. View All Users\n4. Delete User\n5. Exit\n\nYour choice: ";
+            cout << "1. Create Account\n2. Login\n3. View All Users\n4. Delete User\n5. Service Statistics\n6. Exit\n\nYour choice: ";
             cin >> option;
             cin.ignore();
             switch (option) {
             case 1: createAccount(); break;
-            case 2: login(); if (currentUser) userMenu(); break;
+            case 2: login(); if (!currentUser.empty()) userMenu(); break;
             case 3: viewAllUsers(); break;
             case 4: deleteUser(); break;
-            case 5: clearScreen(); printFooter(); saveAccountsToFile(); return;
-            default: cout << "\n\033[1;31mInvalid option.\033[0m\n"; pause(); break;
+            case 5: showStatistics(); break;
+            case 6: clearScreen(); printFooter(); return;
+            default: cout << "\n\033[1;31mInvalid option.\033[0m\n"; pauseScreen(); break;
             }
         }
     }
 };
 
-int main() {
-    ATM atm;
-    atm.run();
+#ifndef ATM_NO_MAIN
+int main(int argc, char* argv[]) {
+    vector<string> args;
+    string dumpPath;
+    int dumpSeconds = 10;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--no-metrics") {
+            metrics.enabled = false;
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            metrics.trace.enable(max<size_t>(1, stoul(argv[++i])));
+        }
+        else if (arg == "--metrics-dump" && i + 1 < argc) {
+            dumpPath = argv[++i];
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) dumpSeconds = stoi(argv[++i]);
+        }
+        else {
+            args.push_back(arg);
+        }
+    }
+    if (!metrics.on() && metrics.trace.enabled()) {
+        cerr << "--trace requires metrics; ignoring --no-metrics." << endl;
+        metrics.enabled = true;
+    }
+
+    Bank bank("accounts.db", "accounts.wal");
+    try {
+        unique_ptr<MetricsDumper> dumper;
+        if (!dumpPath.empty()) dumper = make_unique<MetricsDumper>(dumpPath, dumpSeconds);
+        bank.open();
+        if (!args.empty() && args[0] == "--payroll") {
+            if (args.size() != 2) {
+                cerr << "Usage: " << argv[0] << " --payroll <transfers.csv>" << endl;
+                return 1;
+            }
+            ifstream in(args[1]);
+            if (!in) throw runtime_error("Cannot read " + args[1]);
+            vector<TransferRequest> requests;
+            string line;
+            while (getline(in, line)) {
+                stringstream ss(line);
+                TransferRequest request;
+                string amount;
+                if (getline(ss, request.from, ',') && getline(ss, request.to, ',') && getline(ss, amount)) {
+                    if (!parseMoney(amount, request.amount)) request.amount = 0;
+                    requests.push_back(request);
+                }
+            }
+            auto start = chrono::steady_clock::now();
+            vector<BankStatus> results = bank.transferBatch(requests);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            size_t failed = 0;
+            for (size_t i = 0; i < results.size(); ++i) {
+                if (results[i] == BankStatus::Ok) continue;
+                if (failed++ < 10) cerr << "Line " << i + 1 << ": " << statusMessage(results[i]) << endl;
+            }
+            cout << "Applied " << results.size() - failed << " of " << results.size() << " transfers in "
+                << fixed << setprecision(3) << seconds << "s" << endl;
+        }
+        else if (!args.empty() && args[0] == "--server") {
+#ifdef _WIN32
+            cerr << "Server mode requires a POSIX system." << endl;
+            return 1;
+#else
+            string socketPath = args.size() > 1 ? args[1] : "atm.sock";
+            size_t workers = args.size() > 2 ? stoul(args[2]) : max(1u, thread::hardware_concurrency());
+            AtmServer server(bank, socketPath, workers);
+            server.run();
+#endif
+        }
+        else {
+            ATM atm(bank);
+            atm.run();
+        }
+        bank.close();
+    }
+    catch (const exception& ex) {
+        cerr << "Error: " << ex.what() << endl;
+        return 1;
+    }
     return 0;
 }
+#endif
@@ -12,6 +12,11 @@
 #include <ctime>
 #include <stack>
 #include <cctype>
+#include <cstdint>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <atomic>
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -19,6 +24,8 @@
 using namespace std;
 
 double lastResult = 0.0;
+bool highPrecisionMode = false;
+int precisionDigits = 50;
 
 void applyConsoleColor(int colorCode) {
 #ifdef _WIN32
@@ -80,11 +87,6 @@ double parseFunction(const string& name, double arg) {
 }
 
 double evaluateExpression(string expr) {
-    size_t pos;
-    while ((pos = expr.find("ans")) != string::npos) {
-        expr.replace(pos, 3, to_string(lastResult));
-    }
-
     stack<double> values;
     stack<char> ops;
     size_t i = 0;
@@ -96,6 +98,10 @@ double evaluateExpression(string expr) {
         if (isalpha(expr[i])) {
             string func;
             while (i < expr.size() && isalpha(expr[i])) func += expr[i++];
+            if (func == "ans") {
+                values.push(lastResult);
+                continue;
+            }
             if (expr[i] != '(') throw runtime_error("Expected '(' after function name");
             int start = ++i, count = 1;
             while (i < expr.size() && count > 0) {
@@ -145,16 +151,641 @@ double evaluateExpression(string expr) {
     return values.top();
 }
 
-void logResult(const string& expression, double result) {
+class BigFloat {
+public:
+    static constexpr uint32_t BASE = 1000000000;
+    static constexpr int BASE_DIGITS = 9;
+    static constexpr size_t KARATSUBA_THRESHOLD = 40;
+    static int workingLimbs;
+
+    bool negative = false;
+    vector<uint32_t> limbs;
+    long long exponent = 0;
+
+    BigFloat() {}
+
+    BigFloat(long long value) {
+        negative = value < 0;
+        unsigned long long magnitude = negative ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        while (magnitude > 0) {
+            limbs.push_back((uint32_t)(magnitude % BASE));
+            magnitude /= BASE;
+        }
+        normalize();
+    }
+
+    struct PrecisionScope {
+        int saved;
+        explicit PrecisionScope(int limbCount) : saved(workingLimbs) { workingLimbs = limbCount; }
+        ~PrecisionScope() { workingLimbs = saved; }
+    };
+
+    static int limbsForDigits(int digits) {
+        return (digits + BASE_DIGITS - 1) / BASE_DIGITS + 1;
+    }
+
+    bool isZero() const { return limbs.empty(); }
+
+    long long topPosition() const { return exponent + (long long)limbs.size(); }
+
+    static BigFloat fromString(const string& text) {
+        size_t i = 0;
+        bool neg = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) neg = text[i++] == '-';
+        string digits;
+        long long pointPos = -1, exp10 = 0;
+        for (; i < text.size(); ++i) {
+            char ch = text[i];
+            if (isdigit((unsigned char)ch)) digits += ch;
+            else if (ch == '.' && pointPos < 0) pointPos = (long long)digits.size();
+            else if ((ch == 'e' || ch == 'E') && i + 1 < text.size()) {
+                exp10 = stoll(text.substr(i + 1));
+                break;
+            }
+            else throw runtime_error("Invalid number: " + text);
+        }
+        if (digits.empty()) throw runtime_error("Invalid number: " + text);
+
+        long long scale10 = exp10 - (pointPos < 0 ? 0 : (long long)digits.size() - pointPos);
+        long long pad = ((scale10 % BASE_DIGITS) + BASE_DIGITS) % BASE_DIGITS;
+        digits.append((size_t)pad, '0');
+        scale10 -= pad;
+
+        BigFloat result;
+        for (long long end = (long long)digits.size(); end > 0; end -= BASE_DIGITS) {
+            long long start = max(0LL, end - BASE_DIGITS);
+            result.limbs.push_back((uint32_t)stoul(digits.substr((size_t)start, (size_t)(end - start))));
+        }
+        result.exponent = scale10 / BASE_DIGITS;
+        result.negative = neg;
+        result.roundTo(workingLimbs);
+        return result;
+    }
+
+    static BigFloat fromDouble(double value) {
+        if (value == 0.0) return BigFloat();
+        ostringstream oss;
+        oss << scientific << setprecision(17) << value;
+        return fromString(oss.str());
+    }
+
+    double scaledDouble(long long limbExponent) const {
+        double result = 0.0;
+        size_t lowest = limbs.size() > 3 ? limbs.size() - 3 : 0;
+        for (size_t i = limbs.size(); i-- > lowest;) {
+            result += limbs[i] * pow(1e9, (double)(exponent + (long long)i - limbExponent));
+        }
+        return negative ? -result : result;
+    }
+
+    double toDouble() const { return scaledDouble(0); }
+
+    string toString(int digits) const {
+        if (isZero()) return "0";
+        string s = to_string(limbs.back());
+        for (size_t i = limbs.size() - 1; i-- > 0;) {
+            string part = to_string(limbs[i]);
+            s += string(BASE_DIGITS - part.size(), '0') + part;
+        }
+        long long pointExp = exponent * BASE_DIGITS;
+
+        if ((long long)s.size() > digits) {
+            size_t keep = (size_t)digits;
+            bool restNonZero = s.find_first_not_of('0', keep + 1) != string::npos;
+            bool roundUp = s[keep] > '5' || (s[keep] == '5' && (restNonZero || (s[keep - 1] - '0') % 2 == 1));
+            pointExp += (long long)(s.size() - keep);
+            s.resize(keep);
+            if (roundUp) {
+                long long i = (long long)keep - 1;
+                while (i >= 0 && s[(size_t)i] == '9') s[(size_t)i--] = '0';
+                if (i < 0) {
+                    s.insert(s.begin(), '1');
+                    s.pop_back();
+                    ++pointExp;
+                }
+                else {
+                    ++s[(size_t)i];
+                }
+            }
+        }
+        while (s.size() > 1 && s.back() == '0') {
+            s.pop_back();
+            ++pointExp;
+        }
+
+        long long sciExp = (long long)s.size() - 1 + pointExp;
+        string out = negative ? "-" : "";
+        if (sciExp >= -10 && sciExp < digits) {
+            if (pointExp >= 0) {
+                out += s + string((size_t)pointExp, '0');
+            }
+            else {
+                long long intDigits = (long long)s.size() + pointExp;
+                if (intDigits > 0) out += s.substr(0, (size_t)intDigits) + "." + s.substr((size_t)intDigits);
+                else out += "0." + string((size_t)-intDigits, '0') + s;
+            }
+        }
+        else {
+            out += s[0];
+            if (s.size() > 1) out += "." + s.substr(1);
+            out += "e" + to_string(sciExp);
+        }
+        return out;
+    }
+
+    void normalize() {
+        trimHigh(limbs);
+        size_t low = 0;
+        while (low < limbs.size() && limbs[low] == 0) ++low;
+        if (low > 0) {
+            limbs.erase(limbs.begin(), limbs.begin() + (long long)low);
+            exponent += (long long)low;
+        }
+        if (limbs.empty()) {
+            negative = false;
+            exponent = 0;
+        }
+    }
+
+    void roundTo(int maxLimbs) {
+        normalize();
+        if ((long long)limbs.size() <= maxLimbs) return;
+        size_t drop = limbs.size() - (size_t)maxLimbs;
+        uint32_t first = limbs[drop - 1];
+        bool restNonZero = any_of(limbs.begin(), limbs.begin() + (long long)(drop - 1), [](uint32_t l) { return l != 0; });
+        bool roundUp = first > BASE / 2 || (first == BASE / 2 && (restNonZero || (limbs[drop] & 1)));
+        limbs.erase(limbs.begin(), limbs.begin() + (long long)drop);
+        exponent += (long long)drop;
+        if (roundUp) {
+            size_t i = 0;
+            while (i < limbs.size() && limbs[i] == BASE - 1) limbs[i++] = 0;
+            if (i == limbs.size()) limbs.push_back(1);
+            else ++limbs[i];
+        }
+        normalize();
+    }
+
+    BigFloat truncated() const {
+        if (exponent >= 0) return *this;
+        if (topPosition() <= 0) return BigFloat();
+        BigFloat result = *this;
+        result.limbs.erase(result.limbs.begin(), result.limbs.begin() + (long long)-exponent);
+        result.exponent = 0;
+        result.normalize();
+        return result;
+    }
+
+    BigFloat mulSmall(uint32_t factor) const {
+        BigFloat result = *this;
+        uint64_t carry = 0;
+        for (auto& limb : result.limbs) {
+            uint64_t cur = (uint64_t)limb * factor + carry;
+            limb = (uint32_t)(cur % BASE);
+            carry = cur / BASE;
+        }
+        while (carry > 0) {
+            result.limbs.push_back((uint32_t)(carry % BASE));
+            carry /= BASE;
+        }
+        result.roundTo(workingLimbs);
+        return result;
+    }
+
+    BigFloat divSmall(uint32_t divisor) const {
+        if (divisor == 0) throw runtime_error("Division by zero");
+        BigFloat result = *this;
+        size_t wanted = (size_t)workingLimbs + 1;
+        if (result.limbs.size() < wanted) {
+            size_t extra = wanted - result.limbs.size();
+            result.limbs.insert(result.limbs.begin(), extra, 0);
+            result.exponent -= (long long)extra;
+        }
+        uint64_t remainder = 0;
+        for (size_t i = result.limbs.size(); i-- > 0;) {
+            uint64_t cur = remainder * BASE + result.limbs[i];
+            result.limbs[i] = (uint32_t)(cur / divisor);
+            remainder = cur % divisor;
+        }
+        result.roundTo(workingLimbs);
+        return result;
+    }
+
+    friend BigFloat operator-(const BigFloat& a) {
+        BigFloat result = a;
+        if (!result.isZero()) result.negative = !result.negative;
+        return result;
+    }
+
+    friend BigFloat operator+(const BigFloat& a, const BigFloat& b) { return addSigned(a, b, false); }
+    friend BigFloat operator-(const BigFloat& a, const BigFloat& b) { return addSigned(a, b, true); }
+
+    friend BigFloat operator*(const BigFloat& a, const BigFloat& b) {
+        BigFloat result;
+        if (a.isZero() || b.isZero()) return result;
+        result.limbs = mulMag(a.limbs, b.limbs);
+        result.exponent = a.exponent + b.exponent;
+        result.negative = a.negative != b.negative;
+        result.roundTo(workingLimbs);
+        return result;
+    }
+
+    friend BigFloat operator/(const BigFloat& a, const BigFloat& b) {
+        if (b.isZero()) throw runtime_error("Division by zero");
+        return a * reciprocal(b);
+    }
+
+    static BigFloat reciprocal(const BigFloat& b) {
+        if (b.isZero()) throw runtime_error("Division by zero");
+        int target = workingLimbs;
+        long long scale = b.topPosition() - 2;
+        BigFloat x = fromDouble(1.0 / b.scaledDouble(scale));
+        x.exponent -= scale;
+        for (int p : newtonSchedule(target + 1)) {
+            PrecisionScope scope(p);
+            BigFloat bp = b;
+            bp.roundTo(p);
+            x = x + x * (BigFloat(1) - bp * x);
+        }
+        x.roundTo(target);
+        return x;
+    }
+
+    static BigFloat sqrt(const BigFloat& x) {
+        if (x.negative) throw runtime_error("Square root of negative number");
+        if (x.isZero()) return BigFloat();
+        int target = workingLimbs;
+        long long scale = x.topPosition() - 2;
+        if (scale % 2 != 0) scale -= 1;
+        BigFloat y = fromDouble(1.0 / std::sqrt(x.scaledDouble(scale)));
+        y.exponent -= scale / 2;
+        for (int p : newtonSchedule(target + 1)) {
+            PrecisionScope scope(p);
+            BigFloat xp = x;
+            xp.roundTo(p);
+            y = y + (y * (BigFloat(1) - xp * y * y)).divSmall(2);
+        }
+        BigFloat s;
+        {
+            PrecisionScope scope(target + 1);
+            s = x * y;
+            s = s + ((x - s * s) * y).divSmall(2);
+        }
+        s.roundTo(target);
+        return s;
+    }
+
+    static BigFloat pi() {
+        static BigFloat cached;
+        static int cachedLimbs = 0;
+        if (cachedLimbs < workingLimbs) {
+            int target = workingLimbs;
+            PrecisionScope scope(target + 1);
+            cached = atanInverse(5).mulSmall(16) - atanInverse(239).mulSmall(4);
+            cachedLimbs = target;
+        }
+        BigFloat result = cached;
+        result.roundTo(workingLimbs);
+        return result;
+    }
+
+    static BigFloat ln(const BigFloat& x) {
+        if (x.negative || x.isZero()) throw runtime_error("Logarithm of non-positive number");
+        int target = workingLimbs;
+        BigFloat result;
+        {
+            PrecisionScope scope(target + 2);
+            long long scale = x.topPosition() - 1;
+            BigFloat mantissa = x;
+            mantissa.exponent -= scale;
+            result = lnReduced(mantissa);
+            if (scale != 0) result = result + ln10() * BigFloat(scale * BASE_DIGITS);
+        }
+        result.roundTo(target);
+        return result;
+    }
+
+    static void sinCos(const BigFloat& x, BigFloat& s, BigFloat& c) {
+        int target = workingLimbs;
+        int halvings = 8 + (int)std::sqrt((double)target * BASE_DIGITS) / 3;
+        {
+            PrecisionScope scope(target + 2 + halvings / 30 + (int)max(0LL, x.topPosition()));
+            BigFloat twoPi = pi().mulSmall(2);
+            BigFloat turns = x / twoPi;
+            turns = (turns + (turns.negative ? -BigFloat(1) : BigFloat(1)).divSmall(2)).truncated();
+            BigFloat r = x - turns * twoPi;
+            for (int h = 0; h < halvings; h += 16) r = r.divSmall(1u << min(16, halvings - h));
+
+            BigFloat r2 = r * r;
+            BigFloat sinTerm = r, cosTerm(1);
+            s = r;
+            c = BigFloat(1);
+            for (uint32_t k = 1;; ++k) {
+                sinTerm = -(sinTerm * r2).divSmall((2 * k) * (2 * k + 1));
+                cosTerm = -(cosTerm * r2).divSmall((2 * k - 1) * (2 * k));
+                bool sinDone = isNegligible(sinTerm, s);
+                bool cosDone = isNegligible(cosTerm, c);
+                if (!sinDone) s = s + sinTerm;
+                if (!cosDone) c = c + cosTerm;
+                if (sinDone && cosDone) break;
+            }
+            for (int h = 0; h < halvings; ++h) {
+                BigFloat doubledSin = (s * c).mulSmall(2);
+                c = BigFloat(1) - (s * s).mulSmall(2);
+                s = doubledSin;
+            }
+        }
+        s.roundTo(target);
+        c.roundTo(target);
+    }
+
+private:
+    static void trimHigh(vector<uint32_t>& a) {
+        while (!a.empty() && a.back() == 0) a.pop_back();
+    }
+
+    static int compareMag(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+        for (size_t i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    static vector<uint32_t> shifted(const vector<uint32_t>& a, size_t count) {
+        if (a.empty()) return a;
+        vector<uint32_t> result(count, 0);
+        result.insert(result.end(), a.begin(), a.end());
+        return result;
+    }
+
+    static vector<uint32_t> addMag(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        vector<uint32_t> result(max(a.size(), b.size()) + 1, 0);
+        uint64_t carry = 0;
+        for (size_t i = 0; i + 1 < result.size(); ++i) {
+            uint64_t sum = carry + (i < a.size() ? a[i] : 0) + (i < b.size() ? b[i] : 0);
+            result[i] = (uint32_t)(sum % BASE);
+            carry = sum / BASE;
+        }
+        result.back() = (uint32_t)carry;
+        trimHigh(result);
+        return result;
+    }
+
+    static vector<uint32_t> subMag(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        vector<uint32_t> result(a.size(), 0);
+        int64_t borrow = 0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            int64_t diff = (int64_t)a[i] - borrow - (i < b.size() ? (int64_t)b[i] : 0);
+            borrow = diff < 0;
+            result[i] = (uint32_t)(diff < 0 ? diff + BASE : diff);
+        }
+        trimHigh(result);
+        return result;
+    }
+
+    static vector<uint32_t> mulSchoolbook(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        if (a.empty() || b.empty()) return {};
+        vector<uint32_t> result(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size(); ++j) {
+                uint64_t cur = result[i + j] + (uint64_t)a[i] * b[j] + carry;
+                result[i + j] = (uint32_t)(cur % BASE);
+                carry = cur / BASE;
+            }
+            result[i + b.size()] = (uint32_t)carry;
+        }
+        trimHigh(result);
+        return result;
+    }
+
+    static vector<uint32_t> mulMag(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        if (min(a.size(), b.size()) < KARATSUBA_THRESHOLD) return mulSchoolbook(a, b);
+        size_t half = max(a.size(), b.size()) / 2;
+        auto split = [half](const vector<uint32_t>& v, vector<uint32_t>& low, vector<uint32_t>& high) {
+            size_t cut = min(half, v.size());
+            low.assign(v.begin(), v.begin() + (long long)cut);
+            high.assign(v.begin() + (long long)cut, v.end());
+            trimHigh(low);
+            trimHigh(high);
+        };
+        vector<uint32_t> a0, a1, b0, b1;
+        split(a, a0, a1);
+        split(b, b0, b1);
+        vector<uint32_t> z0 = mulMag(a0, b0);
+        vector<uint32_t> z2 = mulMag(a1, b1);
+        vector<uint32_t> z1 = subMag(subMag(mulMag(addMag(a0, a1), addMag(b0, b1)), z0), z2);
+        return addMag(addMag(z0, shifted(z1, half)), shifted(z2, 2 * half));
+    }
+
+    static BigFloat addSigned(const BigFloat& a, const BigFloat& b, bool negateB) {
+        bool bNegative = b.negative != negateB;
+        if (b.isZero()) return a;
+        if (a.isZero()) {
+            BigFloat result = b;
+            result.negative = bNegative;
+            return result;
+        }
+        long long limit = workingLimbs + 2;
+        if (a.topPosition() - b.topPosition() > limit) return a;
+        if (b.topPosition() - a.topPosition() > limit) {
+            BigFloat result = b;
+            result.negative = bNegative;
+            return result;
+        }
+
+        long long base = min(a.exponent, b.exponent);
+        vector<uint32_t> am = shifted(a.limbs, (size_t)(a.exponent - base));
+        vector<uint32_t> bm = shifted(b.limbs, (size_t)(b.exponent - base));
+        BigFloat result;
+        result.exponent = base;
+        if (a.negative == bNegative) {
+            result.limbs = addMag(am, bm);
+            result.negative = a.negative;
+        }
+        else if (compareMag(am, bm) >= 0) {
+            result.limbs = subMag(am, bm);
+            result.negative = a.negative;
+        }
+        else {
+            result.limbs = subMag(bm, am);
+            result.negative = bNegative;
+        }
+        result.roundTo(workingLimbs);
+        return result;
+    }
+
+    static vector<int> newtonSchedule(int target) {
+        vector<int> steps;
+        for (int p = target; p > 3; p = p / 2 + 1) steps.push_back(p);
+        steps.push_back(3);
+        reverse(steps.begin(), steps.end());
+        steps.push_back(target);
+        return steps;
+    }
+
+    static bool isNegligible(const BigFloat& term, const BigFloat& sum) {
+        if (term.isZero()) return true;
+        long long reference = sum.isZero() ? 1 : sum.topPosition();
+        return reference - term.topPosition() > workingLimbs;
+    }
+
+    static BigFloat atanInverse(uint32_t n) {
+        BigFloat power = BigFloat(1).divSmall(n);
+        BigFloat sum = power;
+        for (uint32_t k = 1;; ++k) {
+            power = power.divSmall(n * n);
+            BigFloat term = power.divSmall(2 * k + 1);
+            if (isNegligible(term, sum)) break;
+            sum = (k % 2 == 1) ? sum - term : sum + term;
+        }
+        return sum;
+    }
+
+    static BigFloat lnReduced(BigFloat mantissa) {
+        int halvings = 0;
+        while (mantissa.toDouble() > 1.000001) {
+            mantissa = sqrt(mantissa);
+            ++halvings;
+        }
+        BigFloat z = (mantissa - BigFloat(1)) / (mantissa + BigFloat(1));
+        BigFloat z2 = z * z;
+        BigFloat power = z, sum = z;
+        for (uint32_t k = 1;; ++k) {
+            power = power * z2;
+            BigFloat term = power.divSmall(2 * k + 1);
+            if (isNegligible(term, sum)) break;
+            sum = sum + term;
+        }
+        sum = sum.mulSmall(2);
+        for (int h = 0; h < halvings; ++h) sum = sum.mulSmall(2);
+        return sum;
+    }
+
+    static BigFloat ln10() {
+        static BigFloat cached;
+        static int cachedLimbs = 0;
+        if (cachedLimbs < workingLimbs) {
+            int target = workingLimbs;
+            PrecisionScope scope(target + 2);
+            cached = lnReduced(BigFloat(10));
+            cachedLimbs = target;
+        }
+        BigFloat result = cached;
+        result.roundTo(workingLimbs);
+        return result;
+    }
+};
+
+int BigFloat::workingLimbs = BigFloat::limbsForDigits(50);
+
+BigFloat lastPreciseResult;
+
+BigFloat applyPreciseOperator(const BigFloat& a, const BigFloat& b, char op) {
+    switch (op) {
+    case '+': return a + b;
+    case '-': return a - b;
+    case '*': return a * b;
+    case '/':
+        if (b.isZero()) throw runtime_error("Division by zero");
+        return a / b;
+    default: throw runtime_error("Unsupported operator");
+    }
+}
+
+BigFloat parsePreciseFunction(const string& name, const BigFloat& arg) {
+    if (name == "sin" || name == "cos" || name == "tan") {
+        BigFloat s, c;
+        BigFloat::sinCos(arg, s, c);
+        if (name == "sin") return s;
+        if (name == "cos") return c;
+        if (c.isZero()) throw runtime_error("tan undefined for this argument");
+        return s / c;
+    }
+    if (name == "sqrt") return BigFloat::sqrt(arg);
+    if (name == "log") return BigFloat::ln(arg);
+    throw runtime_error("Unknown function: " + name + "\nTry: sin, cos, tan, sqrt, log");
+}
+
+BigFloat evaluatePreciseExpression(const string& expr) {
+    stack<BigFloat> values;
+    stack<char> ops;
+    auto reduce = [&]() {
+        if (values.size() < 2) throw runtime_error("Malformed expression");
+        BigFloat b = values.top(); values.pop();
+        BigFloat a = values.top(); values.pop();
+        char op = ops.top(); ops.pop();
+        values.push(applyPreciseOperator(a, b, op));
+    };
+
+    size_t i = 0;
+    while (i < expr.size()) {
+        if (isspace(expr[i])) {
+            ++i;
+            continue;
+        }
+        if (isalpha(expr[i])) {
+            string func;
+            while (i < expr.size() && isalpha(expr[i])) func += expr[i++];
+            if (func == "ans") {
+                values.push(lastPreciseResult);
+                continue;
+            }
+            if (i >= expr.size() || expr[i] != '(') throw runtime_error("Expected '(' after function name");
+            size_t start = ++i;
+            int count = 1;
+            while (i < expr.size() && count > 0) {
+                if (expr[i] == '(') count++;
+                else if (expr[i] == ')') count--;
+                ++i;
+            }
+            if (count != 0) throw runtime_error("Mismatched parentheses in function argument");
+            BigFloat argVal = evaluatePreciseExpression(expr.substr(start, i - start - 1));
+            values.push(parsePreciseFunction(func, argVal));
+        }
+        else if (isdigit(expr[i]) || expr[i] == '.') {
+            string val;
+            while (i < expr.size() && (isdigit(expr[i]) || expr[i] == '.')) val += expr[i++];
+            values.push(BigFloat::fromString(val));
+        }
+        else if (expr[i] == '(') {
+            ops.push(expr[i++]);
+        }
+        else if (expr[i] == ')') {
+            while (!ops.empty() && ops.top() != '(') reduce();
+            if (!ops.empty()) ops.pop();
+            ++i;
+        }
+        else {
+            while (!ops.empty() && precedence(ops.top()) >= precedence(expr[i])) reduce();
+            ops.push(expr[i++]);
+        }
+    }
+    while (!ops.empty()) reduce();
+    if (values.empty()) throw runtime_error("Empty expression");
+    return values.top();
+}
+
+void logResult(const string& expression, const string& result) {
     ofstream logFile("calc_history.log", ios::app);
     time_t now = time(nullptr);
     tm localTm{};
+#ifdef _WIN32
     localtime_s(&localTm, &now);
+#else
+    localtime_r(&now, &localTm);
+#endif
     logFile << put_time(&localTm, "%Y-%m-%d %H:%M:%S") << " | "
         << expression << " = " << result << endl;
     logFile.close();
 }
 
+void logResult(const string& expression, double result) {
+    ostringstream oss;
+    oss << result;
+    logResult(expression, oss.str());
+}
+
 
 void displayHistory() {
     ifstream logFile("calc_history.log");
@@ -176,9 +807,392 @@ void clearHistory() {
     cout << "\nHistory cleared.\n";
 }
 
+enum class OpCode { PushConst, PushX, Add, Sub, Mul, Div, Neg, Sin, Cos, Tan, Sqrt, Log };
+
+struct Instruction {
+    OpCode code;
+    double value;
+};
+
+struct CompiledExpression {
+    vector<Instruction> program;
+    size_t maxStack = 0;
+
+    double evaluate(double x) const {
+        double local[64];
+        vector<double> heap;
+        double* stackBase = local;
+        if (maxStack > 64) {
+            heap.resize(maxStack);
+            stackBase = heap.data();
+        }
+        double* top = stackBase;
+        for (const auto& ins : program) {
+            switch (ins.code) {
+            case OpCode::PushConst: *top++ = ins.value; break;
+            case OpCode::PushX: *top++ = x; break;
+            case OpCode::Add: --top; top[-1] += top[0]; break;
+            case OpCode::Sub: --top; top[-1] -= top[0]; break;
+            case OpCode::Mul: --top; top[-1] *= top[0]; break;
+            case OpCode::Div: --top; top[-1] /= top[0]; break;
+            case OpCode::Neg: top[-1] = -top[-1]; break;
+            case OpCode::Sin: top[-1] = sin(top[-1]); break;
+            case OpCode::Cos: top[-1] = cos(top[-1]); break;
+            case OpCode::Tan: top[-1] = tan(top[-1]); break;
+            case OpCode::Sqrt: top[-1] = sqrt(top[-1]); break;
+            case OpCode::Log: top[-1] = log(top[-1]); break;
+            }
+        }
+        return top[-1];
+    }
+};
+
+OpCode functionOpCode(const string& name) {
+    if (name == "sin") return OpCode::Sin;
+    if (name == "cos") return OpCode::Cos;
+    if (name == "tan") return OpCode::Tan;
+    if (name == "sqrt") return OpCode::Sqrt;
+    if (name == "log") return OpCode::Log;
+    throw runtime_error("Unknown function: " + name + "\nTry: sin, cos, tan, sqrt, log");
+}
+
+void emitOperator(vector<Instruction>& program, char op) {
+    switch (op) {
+    case '+': program.push_back({ OpCode::Add, 0.0 }); break;
+    case '-': program.push_back({ OpCode::Sub, 0.0 }); break;
+    case '*': program.push_back({ OpCode::Mul, 0.0 }); break;
+    case '/': program.push_back({ OpCode::Div, 0.0 }); break;
+    case 'n': program.push_back({ OpCode::Neg, 0.0 }); break;
+    default: throw runtime_error("Unsupported operator");
+    }
+}
+
+int compiledPrecedence(char op) {
+    return op == 'n' ? 3 : precedence(op);
+}
+
+void compileInto(const string& expr, vector<Instruction>& program) {
+    stack<char> ops;
+    bool expectOperand = true;
+    size_t i = 0;
+    while (i < expr.size()) {
+        if (isspace(expr[i])) {
+            ++i;
+            continue;
+        }
+        if (isalpha(expr[i])) {
+            string name;
+            while (i < expr.size() && isalpha(expr[i])) name += expr[i++];
+            if (name == "x") {
+                program.push_back({ OpCode::PushX, 0.0 });
+            }
+            else if (name == "ans") {
+                program.push_back({ OpCode::PushConst, lastResult });
+            }
+            else {
+                OpCode code = functionOpCode(name);
+                if (i >= expr.size() || expr[i] != '(') throw runtime_error("Expected '(' after function name");
+                size_t start = ++i;
+                int count = 1;
+                while (i < expr.size() && count > 0) {
+                    if (expr[i] == '(') count++;
+                    else if (expr[i] == ')') count--;
+                    ++i;
+                }
+                if (count != 0) throw runtime_error("Mismatched parentheses in function argument");
+                compileInto(expr.substr(start, i - start - 1), program);
+                program.push_back({ code, 0.0 });
+            }
+            expectOperand = false;
+        }
+        else if (isdigit(expr[i]) || expr[i] == '.') {
+            string val;
+            while (i < expr.size() && (isdigit(expr[i]) || expr[i] == '.')) val += expr[i++];
+            program.push_back({ OpCode::PushConst, stod(val) });
+            expectOperand = false;
+        }
+        else if (expr[i] == '(') {
+            ops.push(expr[i++]);
+            expectOperand = true;
+        }
+        else if (expr[i] == ')') {
+            while (!ops.empty() && ops.top() != '(') {
+                emitOperator(program, ops.top());
+                ops.pop();
+            }
+            if (!ops.empty()) ops.pop();
+            ++i;
+            expectOperand = false;
+        }
+        else if (expectOperand && (expr[i] == '-' || expr[i] == '+')) {
+            if (expr[i] == '-') ops.push('n');
+            ++i;
+        }
+        else {
+            while (!ops.empty() && compiledPrecedence(ops.top()) >= precedence(expr[i])) {
+                emitOperator(program, ops.top());
+                ops.pop();
+            }
+            ops.push(expr[i++]);
+            expectOperand = true;
+        }
+    }
+    while (!ops.empty()) {
+        if (ops.top() == '(') throw runtime_error("Mismatched parentheses");
+        emitOperator(program, ops.top());
+        ops.pop();
+    }
+}
+
+CompiledExpression compileExpression(const string& expr) {
+    CompiledExpression compiled;
+    compileInto(expr, compiled.program);
+
+    long long depth = 0;
+    for (const auto& ins : compiled.program) {
+        switch (ins.code) {
+        case OpCode::PushConst:
+        case OpCode::PushX: depth++; break;
+        case OpCode::Add:
+        case OpCode::Sub:
+        case OpCode::Mul:
+        case OpCode::Div: depth--; break;
+        default: break;
+        }
+        if (depth < 1) throw runtime_error("Malformed expression");
+        compiled.maxStack = max(compiled.maxStack, (size_t)depth);
+    }
+    if (depth != 1) throw runtime_error("Malformed expression");
+    return compiled;
+}
+
+unsigned workerCount() {
+    return max(1u, thread::hardware_concurrency());
+}
+
+template <typename Fn>
+void parallelFor(size_t count, Fn fn) {
+    size_t workers = min<size_t>(workerCount(), max<size_t>(count, 1));
+    size_t chunk = (count + workers - 1) / workers;
+    vector<thread> threads;
+    for (size_t w = 0; w < workers; ++w) {
+        size_t begin = w * chunk, end = min(count, begin + chunk);
+        if (begin >= end) break;
+        threads.emplace_back([&fn, begin, end]() {
+            for (size_t i = begin; i < end; ++i) fn(i);
+        });
+    }
+    for (auto& t : threads) t.join();
+}
+
+vector<double> tabulate(const CompiledExpression& f, double a, double b, size_t points) {
+    vector<double> values(points);
+    double step = points > 1 ? (b - a) / (double)(points - 1) : 0.0;
+    parallelFor(points, [&](size_t i) { values[i] = f.evaluate(a + step * (double)i); });
+    return values;
+}
+
+const long long MAX_INTEGRAND_EVALUATIONS = 20000000;
+
+struct IntegrationBudget {
+    atomic<long long> remaining{ MAX_INTEGRAND_EVALUATIONS };
+    atomic<bool> notFinite{ false };
+    atomic<bool> exhausted{ false };
+
+    bool stopped() const {
+        return notFinite.load(memory_order_relaxed) || exhausted.load(memory_order_relaxed);
+    }
+};
+
+double adaptiveSimpson(const CompiledExpression& f, double a, double b, double fa, double fm, double fb,
+    double whole, double eps, int depth, IntegrationBudget& budget) {
+    if (budget.stopped()) return 0.0;
+    if (budget.remaining.fetch_sub(2, memory_order_relaxed) <= 0) {
+        budget.exhausted = true;
+        return 0.0;
+    }
+    double m = (a + b) / 2, lm = (a + m) / 2, rm = (m + b) / 2;
+    double flm = f.evaluate(lm), frm = f.evaluate(rm);
+    double left = (m - a) / 6 * (fa + 4 * flm + fm);
+    double right = (b - m) / 6 * (fm + 4 * frm + fb);
+    double delta = left + right - whole;
+    if (!isfinite(flm) || !isfinite(frm) || !isfinite(whole) || !isfinite(delta)) {
+        budget.notFinite = true;
+        return 0.0;
+    }
+    if (depth <= 0 || fabs(delta) <= 15 * eps) return left + right + delta / 15;
+    return adaptiveSimpson(f, a, m, fa, flm, fm, left, eps / 2, depth - 1, budget)
+        + adaptiveSimpson(f, m, b, fm, frm, fb, right, eps / 2, depth - 1, budget);
+}
+
+double integrate(const CompiledExpression& f, double a, double b, double tolerance = 1e-10) {
+    if (!isfinite(a) || !isfinite(b)) throw runtime_error("Integration bounds must be finite");
+    size_t pieces = workerCount() * 4;
+    vector<double> partial(pieces);
+    double width = (b - a) / (double)pieces;
+    IntegrationBudget budget;
+    parallelFor(pieces, [&](size_t i) {
+        double lo = a + width * (double)i, hi = (i + 1 == pieces) ? b : lo + width;
+        double flo = f.evaluate(lo), fmid = f.evaluate((lo + hi) / 2), fhi = f.evaluate(hi);
+        double whole = (hi - lo) / 6 * (flo + 4 * fmid + fhi);
+        if (!isfinite(flo) || !isfinite(fmid) || !isfinite(fhi) || !isfinite(whole)) {
+            budget.notFinite = true;
+            return;
+        }
+        partial[i] = adaptiveSimpson(f, lo, hi, flo, fmid, fhi, whole, tolerance / (double)pieces, 50, budget);
+    });
+    if (budget.notFinite) throw runtime_error("Integrand not finite on the interval");
+    if (budget.exhausted) throw runtime_error("Integral did not converge within " + to_string(MAX_INTEGRAND_EVALUATIONS) + " evaluations");
+    return accumulate(partial.begin(), partial.end(), 0.0);
+}
+
+double brentRoot(const CompiledExpression& f, double a, double b, double fa, double fb, double tolerance = 1e-14) {
+    if (fabs(fa) < fabs(fb)) {
+        swap(a, b);
+        swap(fa, fb);
+    }
+    double c = a, fc = fa, d = b - a;
+    bool bisected = true;
+    for (int iter = 0; iter < 200 && fb != 0.0 && fabs(b - a) > tolerance * max(1.0, fabs(b)); ++iter) {
+        double s;
+        if (fa != fc && fb != fc) {
+            s = a * fb * fc / ((fa - fb) * (fa - fc)) + b * fa * fc / ((fb - fa) * (fb - fc)) + c * fa * fb / ((fc - fa) * (fc - fb));
+        }
+        else {
+            s = b - fb * (b - a) / (fb - fa);
+        }
+        double bound = (3 * a + b) / 4;
+        bool outside = (s - bound) * (s - b) > 0;
+        if (outside || (bisected && fabs(s - b) >= fabs(b - c) / 2) || (!bisected && fabs(s - b) >= fabs(c - d) / 2)) {
+            s = (a + b) / 2;
+            bisected = true;
+        }
+        else {
+            bisected = false;
+        }
+        double fs = f.evaluate(s);
+        d = c;
+        c = b;
+        fc = fb;
+        if (fa * fs < 0) {
+            b = s;
+            fb = fs;
+        }
+        else {
+            a = s;
+            fa = fs;
+        }
+        if (fabs(fa) < fabs(fb)) {
+            swap(a, b);
+            swap(fa, fb);
+        }
+    }
+    return b;
+}
+
+vector<double> findRoots(const CompiledExpression& f, double a, double b, size_t samples) {
+    samples = max<size_t>(samples, 2);
+    vector<double> xs(samples);
+    double step = (b - a) / (double)(samples - 1);
+    for (size_t i = 0; i < samples; ++i) xs[i] = a + step * (double)i;
+    xs.back() = b;
+    vector<double> ys = tabulate(f, a, b, samples);
+
+    vector<size_t> brackets;
+    vector<double> roots;
+    for (size_t i = 0; i < samples; ++i) {
+        if (ys[i] == 0.0) roots.push_back(xs[i]);
+        else if (i + 1 < samples && ys[i + 1] != 0.0 && ys[i] * ys[i + 1] < 0) brackets.push_back(i);
+    }
+    vector<double> refined(brackets.size());
+    parallelFor(brackets.size(), [&](size_t k) {
+        size_t i = brackets[k];
+        double root = brentRoot(f, xs[i], xs[i + 1], ys[i], ys[i + 1]);
+        double residual = fabs(f.evaluate(root));
+        refined[k] = residual <= 1e-8 * max({ 1.0, fabs(ys[i]), fabs(ys[i + 1]) }) ? root : NAN;
+    });
+    for (double root : refined) {
+        if (!isnan(root)) roots.push_back(root);
+    }
+    sort(roots.begin(), roots.end());
+    return roots;
+}
+
+vector<string> splitTrailingArguments(const string& text, size_t count, string& body) {
+    vector<string> args;
+    size_t end = text.find_last_not_of(" \t");
+    while (args.size() < count && end != string::npos) {
+        size_t start = text.find_last_of(" \t", end);
+        size_t from = (start == string::npos) ? 0 : start + 1;
+        args.insert(args.begin(), text.substr(from, end - from + 1));
+        if (start == string::npos) {
+            end = string::npos;
+            break;
+        }
+        end = text.find_last_not_of(" \t", start);
+    }
+    if (args.size() < count || end == string::npos) throw runtime_error("Not enough arguments");
+    body = text.substr(0, end + 1);
+    return args;
+}
+
+double parseBound(const string& text) {
+    return compileExpression(text).evaluate(0.0);
+}
+
+bool processRangeCommand(const string& input) {
+    string command = input.substr(0, input.find(' '));
+    if (command != "table" && command != "integrate" && command != "roots") return false;
+
+    string rest = input.size() > command.size() ? input.substr(command.size() + 1) : "";
+    string body;
+    try {
+        if (command == "table") {
+            vector<string> args = splitTrailingArguments(rest, 3, body);
+            CompiledExpression f = compileExpression(body);
+            double a = parseBound(args[0]), b = parseBound(args[1]);
+            long long points = stoll(args[2]);
+            if (points < 1) throw runtime_error("Point count must be positive");
+            vector<double> values = tabulate(f, a, b, (size_t)points);
+            double step = points > 1 ? (b - a) / (double)(points - 1) : 0.0;
+            cout << "\n" << setw(16) << "x" << " | " << "f(x)\n";
+            for (size_t i = 0; i < values.size(); ++i) {
+                cout << fixed << setprecision(6) << setw(16) << a + step * (double)i << " | " << values[i] << "\n";
+            }
+        }
+        else if (command == "integrate") {
+            vector<string> args = splitTrailingArguments(rest, 2, body);
+            CompiledExpression f = compileExpression(body);
+            double result = integrate(f, parseBound(args[0]), parseBound(args[1]));
+            lastResult = result;
+            applyConsoleColor(2);
+            cout << "Integral: " << fixed << setprecision(10) << result << endl;
+            resetConsoleColor();
+            logResult(input, result);
+        }
+        else {
+            vector<string> args = splitTrailingArguments(rest, 2, body);
+            CompiledExpression f = compileExpression(body);
+            vector<double> roots = findRoots(f, parseBound(args[0]), parseBound(args[1]), 10000);
+            applyConsoleColor(2);
+            if (roots.empty()) cout << "No sign change found in the interval.\n";
+            for (double r : roots) cout << "Root: " << fixed << setprecision(12) << r << "\n";
+            resetConsoleColor();
+        }
+    }
+    catch (const exception& ex) {
+        applyConsoleColor(4);
+        cerr << "Error: " << ex.what() << "\nUsage: table <expr> <a> <b> <n> | integrate <expr> <a> <b> | roots <expr> <a> <b>" << endl;
+        resetConsoleColor();
+    }
+    return true;
+}
+
 void processExpressionDirect() {
     string expression;
-    cout << "\nType expression (e.g. 2+3*(5-2), sin(1.57), history, clear, exit):\n> ";
+    cout << "\nType expression (e.g. 2+3*(5-2), sin(1.57), history, clear, mode precise|fast, precision N,\n"
+        << " table <expr of x> <a> <b> <n>, integrate <expr> <a> <b>, roots <expr> <a> <b>, exit):\n"
+        << (highPrecisionMode ? "[" + to_string(precisionDigits) + " digits] > " : "> ");
     getline(cin, expression);
     if (expression == "exit") {
         renderInterfaceFooter();
@@ -194,9 +1208,44 @@ void processExpressionDirect() {
         clearHistory();
         return;
     }
+    else if (processRangeCommand(expression)) {
+        return;
+    }
+    else if (expression == "mode precise" || expression == "mode fast") {
+        highPrecisionMode = expression == "mode precise";
+        cout << "\nMode: " << (highPrecisionMode ? "high precision (" + to_string(precisionDigits) + " digits)" : "fast (double)") << endl;
+        return;
+    }
+    else if (expression.rfind("precision ", 0) == 0) {
+        try {
+            int digits = stoi(expression.substr(10));
+            if (digits < 1 || digits > 100000) throw out_of_range("precision");
+            precisionDigits = digits;
+            cout << "\nPrecision set to " << precisionDigits << " significant digits.\n";
+        }
+        catch (const exception&) {
+            applyConsoleColor(4);
+            cerr << "Error: precision must be a number between 1 and 100000" << endl;
+            resetConsoleColor();
+        }
+        return;
+    }
     try {
+        if (highPrecisionMode) {
+            BigFloat::workingLimbs = BigFloat::limbsForDigits(precisionDigits);
+            BigFloat result = evaluatePreciseExpression(expression);
+            lastPreciseResult = result;
+            lastResult = result.toDouble();
+            string text = result.toString(precisionDigits);
+            applyConsoleColor(2);
+            cout << "Result: " << text << endl;
+            resetConsoleColor();
+            logResult(expression, text);
+            return;
+        }
         double result = evaluateExpression(expression);
         lastResult = result;
+        lastPreciseResult = BigFloat::fromDouble(result);
         applyConsoleColor(2);
         cout << "Result: " << fixed << setprecision(6) << result << endl;
         resetConsoleColor();
@@ -209,6 +1258,7 @@ void processExpressionDirect() {
     }
 }
 
+#ifndef CALCULATOR_NO_MAIN
 int main() {
     renderInterfaceHeader();
     while (true) {
@@ -217,3 +1267,4 @@ int main() {
     renderInterfaceFooter();
     return 0;
 }
+#endif
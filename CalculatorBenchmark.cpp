@@ -0,0 +1,306 @@
+// File: CalculatorBenchmark.cpp
+// Build: g++ -O2 -std=c++17 CalculatorBenchmark.cpp -o calculator_bench -pthread
+#define CALCULATOR_NO_MAIN
+#include "Calculator.cpp"
+
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#ifdef _MSC_VER
+#define ALLOCATOR_NOINLINE __declspec(noinline)
+#else
+#define ALLOCATOR_NOINLINE __attribute__((noinline))
+#endif
+
+size_t allocationCount = 0;
+
+void* countedAllocate(size_t size) noexcept {
+    ++allocationCount;
+    return malloc(size ? size : 1);
+}
+
+void* countedAllocate(size_t size, align_val_t alignment) noexcept {
+    ++allocationCount;
+    size_t align = max((size_t)alignment, sizeof(void*));
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    return aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+}
+
+void alignedRelease(void* p) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+ALLOCATOR_NOINLINE void* operator new(size_t size) {
+    if (void* p = countedAllocate(size)) return p;
+    throw bad_alloc();
+}
+
+ALLOCATOR_NOINLINE void* operator new[](size_t size) {
+    if (void* p = countedAllocate(size)) return p;
+    throw bad_alloc();
+}
+
+ALLOCATOR_NOINLINE void* operator new(size_t size, align_val_t alignment) {
+    if (void* p = countedAllocate(size, alignment)) return p;
+    throw bad_alloc();
+}
+
+ALLOCATOR_NOINLINE void* operator new[](size_t size, align_val_t alignment) {
+    if (void* p = countedAllocate(size, alignment)) return p;
+    throw bad_alloc();
+}
+
+ALLOCATOR_NOINLINE void* operator new(size_t size, const nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+ALLOCATOR_NOINLINE void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+ALLOCATOR_NOINLINE void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept {
+    return countedAllocate(size, alignment);
+}
+
+ALLOCATOR_NOINLINE void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept {
+    return countedAllocate(size, alignment);
+}
+
+ALLOCATOR_NOINLINE void operator delete(void* p) noexcept { free(p); }
+ALLOCATOR_NOINLINE void operator delete[](void* p) noexcept { free(p); }
+ALLOCATOR_NOINLINE void operator delete(void* p, size_t) noexcept { free(p); }
+ALLOCATOR_NOINLINE void operator delete[](void* p, size_t) noexcept { free(p); }
+ALLOCATOR_NOINLINE void operator delete(void* p, align_val_t) noexcept { alignedRelease(p); }
+ALLOCATOR_NOINLINE void operator delete[](void* p, align_val_t) noexcept { alignedRelease(p); }
+ALLOCATOR_NOINLINE void operator delete(void* p, size_t, align_val_t) noexcept { alignedRelease(p); }
+ALLOCATOR_NOINLINE void operator delete[](void* p, size_t, align_val_t) noexcept { alignedRelease(p); }
+ALLOCATOR_NOINLINE void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+ALLOCATOR_NOINLINE void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+ALLOCATOR_NOINLINE void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { alignedRelease(p); }
+ALLOCATOR_NOINLINE void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { alignedRelease(p); }
+
+struct BenchmarkOptions {
+    size_t count = 20000;
+    int depth = 6;
+    vector<int> operatorWeights = { 4, 4, 3, 1 };
+    double functionProbability = 0.15;
+    double parenProbability = 0.10;
+    double leafProbability = 0.25;
+    unsigned seed = 2025;
+    string baselineFile;
+    string saveBaselineFile;
+    double threshold = 0.20;
+};
+
+class ExpressionGenerator {
+private:
+    const BenchmarkOptions& options;
+    mt19937 rng;
+    discrete_distribution<int> operatorPick;
+    uniform_real_distribution<double> unit{ 0.0, 1.0 };
+
+    string literal() {
+        ostringstream oss;
+        oss << fixed << setprecision(3) << 0.5 + unit(rng) * 99.5;
+        return oss.str();
+    }
+
+public:
+    ExpressionGenerator(const BenchmarkOptions& opts)
+        : options(opts), rng(opts.seed), operatorPick(opts.operatorWeights.begin(), opts.operatorWeights.end()) {}
+
+    string generate(int depth) {
+        if (depth <= 0 || unit(rng) < options.leafProbability) return literal();
+        double r = unit(rng);
+        if (r < options.functionProbability) {
+            static const char* functions[] = { "sin", "cos", "tan", "sqrt", "log" };
+            return string(functions[rng() % 5]) + "(" + generate(depth - 1) + ")";
+        }
+        if (r < options.functionProbability + options.parenProbability) {
+            return "(" + generate(depth - 1) + ")";
+        }
+        static const char operators[] = { '+', '-', '*', '/' };
+        return generate(depth - 1) + operators[operatorPick(rng)] + generate(depth - 1);
+    }
+};
+
+struct PhaseResult {
+    double seconds = 0.0;
+    size_t allocations = 0;
+};
+
+template <typename Fn>
+PhaseResult measure(Fn fn) {
+    size_t allocationsBefore = allocationCount;
+    auto start = chrono::steady_clock::now();
+    fn();
+    auto stop = chrono::steady_clock::now();
+    PhaseResult result;
+    result.seconds = chrono::duration<double>(stop - start).count();
+    result.allocations = allocationCount - allocationsBefore;
+    return result;
+}
+
+bool sameResult(double a, double b) {
+    if (isnan(a) || isnan(b)) return isnan(a) && isnan(b);
+    if (isinf(a) || isinf(b)) return a == b;
+    return fabs(a - b) <= 1e-9 * max(1.0, max(fabs(a), fabs(b)));
+}
+
+void printPhase(const string& name, const PhaseResult& phase, size_t expressions) {
+    cout << left << setw(22) << name
+        << right << setw(14) << fixed << setprecision(0) << expressions / max(phase.seconds, 1e-12) << " expr/s"
+        << setw(12) << setprecision(2) << (double)phase.allocations / max<size_t>(expressions, 1) << " allocs/expr" << endl;
+}
+
+const vector<string> BASELINE_PHASES = { "legacy", "compiled_parse", "compiled_eval" };
+
+map<string, double> readBaseline(const string& filename) {
+    map<string, double> baseline;
+    ifstream in(filename);
+    if (!in) throw runtime_error("Cannot read baseline " + filename);
+    string name;
+    double value;
+    while (in >> name >> value) baseline[name] = value;
+    if (!in.eof()) throw runtime_error("Malformed baseline " + filename);
+    for (const auto& phase : BASELINE_PHASES) {
+        if (!baseline.count(phase)) throw runtime_error("Baseline " + filename + " has no entry for " + phase);
+    }
+    return baseline;
+}
+
+bool parseOptions(int argc, char* argv[], BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        auto next = [&]() -> string {
+            if (i + 1 >= argc) throw runtime_error("Missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--count") options.count = stoul(next());
+        else if (arg == "--depth") options.depth = stoi(next());
+        else if (arg == "--functions") options.functionProbability = stod(next());
+        else if (arg == "--parens") options.parenProbability = stod(next());
+        else if (arg == "--leaf") options.leafProbability = stod(next());
+        else if (arg == "--seed") options.seed = (unsigned)stoul(next());
+        else if (arg == "--baseline") options.baselineFile = next();
+        else if (arg == "--save-baseline") options.saveBaselineFile = next();
+        else if (arg == "--threshold") options.threshold = stod(next());
+        else if (arg == "--mix") {
+            stringstream ss(next());
+            string part;
+            options.operatorWeights.clear();
+            while (getline(ss, part, ',')) options.operatorWeights.push_back(stoi(part));
+            if (options.operatorWeights.size() != 4) throw runtime_error("--mix expects four weights for + - * /");
+        }
+        else {
+            cout << "Usage: calculator_bench [--count N] [--depth D] [--mix add,sub,mul,div] [--functions P]\n"
+                << "                        [--parens P] [--leaf P] [--seed S] [--baseline FILE]\n"
+                << "                        [--save-baseline FILE] [--threshold FRACTION]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    map<string, double> baseline;
+    try {
+        if (!parseOptions(argc, argv, options)) return 2;
+        if (!options.baselineFile.empty()) baseline = readBaseline(options.baselineFile);
+    }
+    catch (const exception& ex) {
+        cerr << "Error: " << ex.what() << endl;
+        return 2;
+    }
+
+    ExpressionGenerator generator(options);
+    vector<string> corpus;
+    corpus.reserve(options.count);
+    size_t totalLength = 0;
+    for (size_t i = 0; i < options.count; ++i) {
+        corpus.push_back(generator.generate(options.depth));
+        totalLength += corpus.back().size();
+    }
+
+    vector<double> legacyResults(corpus.size(), 0.0);
+    vector<bool> legacyFailed(corpus.size(), false);
+    PhaseResult legacy = measure([&]() {
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            try {
+                legacyResults[i] = evaluateExpression(corpus[i]);
+            }
+            catch (const exception&) {
+                legacyFailed[i] = true;
+            }
+        }
+    });
+
+    vector<CompiledExpression> compiled(corpus.size());
+    PhaseResult compile = measure([&]() {
+        for (size_t i = 0; i < corpus.size(); ++i) compiled[i] = compileExpression(corpus[i]);
+    });
+
+    vector<double> compiledResults(corpus.size(), 0.0);
+    PhaseResult evaluate = measure([&]() {
+        for (size_t i = 0; i < compiled.size(); ++i) compiledResults[i] = compiled[i].evaluate(0.0);
+    });
+
+    size_t mismatches = 0, legacyErrors = 0;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        if (legacyFailed[i]) {
+            ++legacyErrors;
+            continue;
+        }
+        if (!sameResult(legacyResults[i], compiledResults[i])) {
+            if (mismatches < 5) {
+                cerr << "Mismatch: " << corpus[i] << "\n  legacy=" << setprecision(17) << legacyResults[i]
+                    << " compiled=" << compiledResults[i] << endl;
+            }
+            ++mismatches;
+        }
+    }
+
+    cout << "Corpus: " << corpus.size() << " expressions, depth " << options.depth
+        << ", mean length " << fixed << setprecision(1) << (double)totalLength / max<size_t>(corpus.size(), 1)
+        << " chars, seed " << options.seed << endl;
+    printPhase("legacy parse+eval", legacy, corpus.size());
+    printPhase("compiled parse", compile, corpus.size());
+    printPhase("compiled eval", evaluate, corpus.size());
+    cout << "Legacy errors (e.g. division by zero): " << legacyErrors << endl;
+    cout << "Result mismatches: " << mismatches << endl;
+
+    map<string, double> current = {
+        { "legacy", corpus.size() / max(legacy.seconds, 1e-12) },
+        { "compiled_parse", corpus.size() / max(compile.seconds, 1e-12) },
+        { "compiled_eval", corpus.size() / max(evaluate.seconds, 1e-12) },
+    };
+
+    int status = mismatches == 0 ? 0 : 1;
+    if (!options.baselineFile.empty()) {
+        for (const auto& phase : BASELINE_PHASES) {
+            double floor = baseline[phase] * (1.0 - options.threshold);
+            if (current[phase] < floor) {
+                cerr << "Regression: " << phase << " " << fixed << setprecision(0) << current[phase]
+                    << " expr/s is below " << floor << " (baseline " << baseline[phase] << ")" << endl;
+                status = 1;
+            }
+        }
+    }
+    if (!options.saveBaselineFile.empty()) {
+        ofstream out(options.saveBaselineFile);
+        for (const auto& entry : current) out << entry.first << " " << fixed << setprecision(0) << entry.second << "\n";
+    }
+    return status;
+}
@@ -2,12 +2,28 @@
 #include <vector>
 #include <iomanip>
 #include <string>
-#include <map>
 #include <fstream>
 #include <algorithm>
 #include <sstream>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <unordered_map>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <cmath>
 #ifdef _WIN32
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 using namespace std;
@@ -21,38 +37,70 @@ using namespace std;
 #define CYAN    "\033[36m"
 #define BOLD    "\033[1m"
 
+enum class Grade : uint8_t { AA, BA, BB, CB, CC, DC, DD, FD, FF };
+
+constexpr size_t GRADE_COUNT = 9;
+constexpr array<double, GRADE_COUNT> gradePoints = { 4.0, 3.5, 3.0, 2.5, 2.0, 1.5, 1.0, 0.5, 0.0 };
+constexpr array<const char*, GRADE_COUNT> gradeNames = { "AA", "BA", "BB", "CB", "CC", "DC", "DD", "FD", "FF" };
+
+static_assert(gradePoints[(size_t)Grade::AA] == 4.0 && gradePoints[(size_t)Grade::FF] == 0.0, "grade table out of order");
+
 struct Course {
     string code;
     string name;
     double credit;
-    string letterGrade;
+    Grade grade;
 };
 
-map<string, double> gradePointMap = {
-    {"AA", 4.0}, {"BA", 3.5}, {"BB", 3.0}, {"CB", 2.5},
-    {"CC", 2.0}, {"DC", 1.5}, {"DD", 1.0}, {"FD", 0.5}, {"FF", 0.0}
-};
+constexpr double gradePoint(Grade g) {
+    return gradePoints[(size_t)g];
+}
 
-const vector<string> validGrades = { "AA", "BA", "BB", "CB", "CC", "DC", "DD", "FD", "FF" };
+const char* gradeName(Grade g) {
+    return gradeNames[(size_t)g];
+}
 
-string line(char symbol = '=', int length = 60) {
-    return string(length, symbol);
+bool parseGrade(string_view text, Grade& g) {
+    if (text.size() != 2) return false;
+    char first = (char)toupper((unsigned char)text[0]), second = (char)toupper((unsigned char)text[1]);
+    for (size_t i = 0; i < GRADE_COUNT; ++i) {
+        if (gradeNames[i][0] == first && gradeNames[i][1] == second) {
+            g = (Grade)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t crc32(string_view data) {
+    static const auto table = []() {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = ~0u;
+    for (unsigned char ch : data) crc = table[(crc ^ ch) & 0xFF] ^ (crc >> 8);
+    return ~crc;
 }
 
-bool isValidGrade(const string& g) {
-    return gradePointMap.find(g) != gradePointMap.end();
+string line(char symbol = '=', int length = 60) {
+    return string(length, symbol);
 }
 
 string formatCourse(const Course& c) {
-    string color = c.letterGrade == "AA" ? GREEN :
-        c.letterGrade == "BA" ? CYAN :
-        c.letterGrade == "BB" ? YELLOW :
-        c.letterGrade == "CB" ? MAGENTA : RED;
+    string color = c.grade == Grade::AA ? GREEN :
+        c.grade == Grade::BA ? CYAN :
+        c.grade == Grade::BB ? YELLOW :
+        c.grade == Grade::CB ? MAGENTA : RED;
     ostringstream oss;
     oss << color << left << setw(10) << c.code
         << setw(25) << c.name
         << setw(7) << c.credit
-        << setw(10) << c.letterGrade << RESET;
+        << setw(10) << gradeName(c.grade) << RESET;
     return oss.str();
 }
 
@@ -64,31 +112,566 @@ void clearScreen() {
 #endif
 }
 
+class MappedFile {
+private:
+    const char* view = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const string& filename) {
+#ifdef _WIN32
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (view) length = (size_t)size.QuadPart;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                view = static_cast<const char*>(p);
+                length = (size_t)st.st_size;
+                madvise(p, length, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (view) munmap(const_cast<char*>(view), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    string_view contents() const { return string_view(view ? view : "", length); }
+};
+
+bool parseCredit(string_view text, double& credit) {
+    auto parsed = from_chars(text.data(), text.data() + text.size(), credit);
+    return parsed.ec == errc() && parsed.ptr == text.data() + text.size();
+}
+
+bool parseCourseLine(string_view line, Course& c) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    size_t pos1 = line.find(',');
+    size_t pos3 = line.rfind(',');
+    if (pos1 == string_view::npos || pos3 == string_view::npos || pos3 == 0) return false;
+    size_t pos2 = line.rfind(',', pos3 - 1);
+    if (pos2 == string_view::npos || pos2 <= pos1) return false;
+
+    string_view creditField = line.substr(pos2 + 1, pos3 - pos2 - 1);
+    double credit = 0.0;
+    if (!parseCredit(creditField, credit)) return false;
+    Grade grade;
+    if (!parseGrade(line.substr(pos3 + 1), grade)) return false;
+
+    c.code.assign(line.substr(0, pos1));
+    c.name.assign(line.substr(pos1 + 1, pos2 - pos1 - 1));
+    c.credit = credit;
+    c.grade = grade;
+    return true;
+}
+
 vector<Course> loadCoursesFromFile(const string& filename) {
     vector<Course> courses;
-    ifstream file(filename);
-    string line;
-    while (getline(file, line)) {
+    MappedFile file(filename);
+    string_view data = file.contents();
+    courses.reserve((size_t)count(data.begin(), data.end(), '\n') + 1);
+    while (!data.empty()) {
+        size_t end = data.find('\n');
+        string_view line = data.substr(0, end);
+        data.remove_prefix(end == string_view::npos ? data.size() : end + 1);
         Course c;
-        size_t pos1 = line.find(',');
-        size_t pos2 = line.find(',', pos1 + 1);
-        size_t pos3 = line.find(',', pos2 + 1);
-        c.code = line.substr(0, pos1);
-        c.name = line.substr(pos1 + 1, pos2 - pos1 - 1);
-        c.credit = stod(line.substr(pos2 + 1, pos3 - pos2 - 1));
-        c.letterGrade = line.substr(pos3 + 1);
-        courses.push_back(c);
+        if (parseCourseLine(line, c)) courses.push_back(move(c));
     }
-    file.close();
     return courses;
 }
 
-void saveCoursesToFile(const vector<Course>& courses, const string& filename) {
+bool saveCoursesToFile(const vector<Course>& courses, const string& filename) {
     ofstream file(filename);
     for (const auto& c : courses) {
-        file << c.code << "," << c.name << "," << c.credit << "," << c.letterGrade << endl;
+        file << c.code << "," << c.name << "," << c.credit << "," << gradeName(c.grade) << '\n';
     }
     file.close();
+    return !file.fail();
+}
+
+const char COURSE_STORE_MAGIC[4] = { 'G', 'P', 'A', 'C' };
+const uint32_t COURSE_STORE_VERSION = 1;
+
+struct CourseStoreHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t courseCount;
+    uint32_t codeCount;
+    uint32_t nameCount;
+    uint32_t stringBytes;
+};
+
+void saveCoursesToBinary(const vector<Course>& courses, const string& filename) {
+    vector<string> codes, names;
+    unordered_map<string, uint32_t> codeIds, nameIds;
+    auto intern = [](const string& value, vector<string>& dict, unordered_map<string, uint32_t>& ids) {
+        auto result = ids.emplace(value, (uint32_t)dict.size());
+        if (result.second) dict.push_back(value);
+        return result.first->second;
+    };
+
+    vector<uint32_t> codeColumn, nameColumn;
+    vector<float> creditColumn;
+    vector<uint8_t> gradeColumn;
+    codeColumn.reserve(courses.size());
+    nameColumn.reserve(courses.size());
+    creditColumn.reserve(courses.size());
+    gradeColumn.reserve(courses.size());
+    for (const auto& c : courses) {
+        codeColumn.push_back(intern(c.code, codes, codeIds));
+        nameColumn.push_back(intern(c.name, names, nameIds));
+        creditColumn.push_back((float)c.credit);
+        gradeColumn.push_back((uint8_t)c.grade);
+    }
+
+    vector<uint32_t> offsets;
+    string blob;
+    for (const auto* dict : { &codes, &names }) {
+        for (const auto& value : *dict) {
+            offsets.push_back((uint32_t)blob.size());
+            blob += value;
+        }
+        offsets.push_back((uint32_t)blob.size());
+    }
+
+    CourseStoreHeader header{};
+    memcpy(header.magic, COURSE_STORE_MAGIC, sizeof(header.magic));
+    header.version = COURSE_STORE_VERSION;
+    header.courseCount = (uint32_t)courses.size();
+    header.codeCount = (uint32_t)codes.size();
+    header.nameCount = (uint32_t)names.size();
+    header.stringBytes = (uint32_t)blob.size();
+
+    ofstream file(filename, ios::binary | ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(offsets.data()), (streamsize)(offsets.size() * sizeof(uint32_t)));
+    file.write(blob.data(), (streamsize)blob.size());
+    file.write(reinterpret_cast<const char*>(codeColumn.data()), (streamsize)(codeColumn.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(nameColumn.data()), (streamsize)(nameColumn.size() * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(creditColumn.data()), (streamsize)(creditColumn.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(gradeColumn.data()), (streamsize)gradeColumn.size());
+    file.close();
+}
+
+constexpr bool gradePointsAreHalfSteps() {
+    for (size_t g = 0; g < GRADE_COUNT; ++g) {
+        if (gradePoints[g] != 4.0 - 0.5 * (double)g) return false;
+    }
+    return true;
+}
+
+static_assert(gradePointsAreHalfSteps(), "calculateGPA over grade columns assumes 0.5-point steps");
+
+double calculateGPA(const uint8_t* grades, const float* credits, size_t count) {
+    const size_t LANES = 8;
+    double halfPoints[LANES] = {}, totals[LANES] = {};
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        for (size_t j = 0; j < LANES; ++j) {
+            halfPoints[j] += (double)(8 - grades[i + j]) * credits[i + j];
+            totals[j] += credits[i + j];
+        }
+    }
+    for (; i < count; ++i) {
+        halfPoints[0] += (double)(8 - grades[i]) * credits[i];
+        totals[0] += credits[i];
+    }
+    double totalPoints = 0.0, totalCredits = 0.0;
+    for (size_t j = 0; j < LANES; ++j) {
+        totalPoints += 0.5 * halfPoints[j];
+        totalCredits += totals[j];
+    }
+    return (totalCredits > 0) ? (totalPoints / totalCredits) : 0.0;
+}
+
+bool loadCoursesFromBinary(const string& filename, vector<Course>& courses, double& gpa) {
+    ifstream file(filename, ios::binary | ios::ate);
+    if (!file) return false;
+    vector<char> buffer((size_t)file.tellg());
+    file.seekg(0);
+    if (!file.read(buffer.data(), (streamsize)buffer.size())) return false;
+
+    CourseStoreHeader header;
+    if (buffer.size() < sizeof(header)) return false;
+    memcpy(&header, buffer.data(), sizeof(header));
+    if (memcmp(header.magic, COURSE_STORE_MAGIC, sizeof(header.magic)) != 0 || header.version != COURSE_STORE_VERSION) return false;
+
+    size_t offsetCount = (size_t)header.codeCount + header.nameCount + 2;
+    size_t n = header.courseCount;
+    size_t expected = sizeof(header) + offsetCount * sizeof(uint32_t) + header.stringBytes
+        + n * (2 * sizeof(uint32_t) + sizeof(float) + sizeof(uint8_t));
+    if (buffer.size() != expected) return false;
+
+    const char* cursor = buffer.data() + sizeof(header);
+    vector<uint32_t> offsets(offsetCount);
+    memcpy(offsets.data(), cursor, offsetCount * sizeof(uint32_t));
+    cursor += offsetCount * sizeof(uint32_t);
+    string_view blob(cursor, header.stringBytes);
+    cursor += header.stringBytes;
+
+    auto dictionary = [&](size_t first, size_t count) {
+        vector<string> dict;
+        dict.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t from = offsets[first + i], to = offsets[first + i + 1];
+            if (from > to || to > blob.size()) return vector<string>();
+            dict.emplace_back(blob.substr(from, to - from));
+        }
+        return dict;
+    };
+    vector<string> codes = dictionary(0, header.codeCount);
+    vector<string> names = dictionary((size_t)header.codeCount + 1, header.nameCount);
+    if (codes.size() != header.codeCount || names.size() != header.nameCount) return false;
+
+    vector<uint32_t> codeColumn(n), nameColumn(n);
+    vector<float> creditColumn(n);
+    vector<uint8_t> gradeColumn(n);
+    memcpy(codeColumn.data(), cursor, n * sizeof(uint32_t));
+    cursor += n * sizeof(uint32_t);
+    memcpy(nameColumn.data(), cursor, n * sizeof(uint32_t));
+    cursor += n * sizeof(uint32_t);
+    memcpy(creditColumn.data(), cursor, n * sizeof(float));
+    cursor += n * sizeof(float);
+    memcpy(gradeColumn.data(), cursor, n);
+
+    vector<Course> loaded(n);
+    for (size_t i = 0; i < n; ++i) {
+        if (codeColumn[i] >= codes.size() || nameColumn[i] >= names.size() || gradeColumn[i] >= GRADE_COUNT) return false;
+        loaded[i].code = codes[codeColumn[i]];
+        loaded[i].name = names[nameColumn[i]];
+        loaded[i].credit = creditColumn[i];
+        loaded[i].grade = (Grade)gradeColumn[i];
+    }
+    gpa = calculateGPA(gradeColumn.data(), creditColumn.data(), n);
+    courses = move(loaded);
+    return true;
+}
+
+double calculateGPA(const vector<Course>& courses) {
+    double totalPoints = 0.0, totalCredits = 0.0;
+    for (const auto& c : courses) {
+        totalPoints += gradePoint(c.grade) * c.credit;
+        totalCredits += c.credit;
+    }
+    return (totalCredits > 0) ? (totalPoints / totalCredits) : 0.0;
+}
+
+struct PlannedCourse {
+    string code;
+    double credit;
+};
+
+struct GradePlan {
+    bool reachable = false;
+    vector<Grade> grades;
+    double projectedGPA = 0.0;
+};
+
+GradePlan planGrades(double currentPoints, double currentCredits, const vector<PlannedCourse>& planned, double targetGPA) {
+    const uint8_t UNREACHABLE = 0xFF;
+    const int TOP_LEVEL = (int)GRADE_COUNT - 1;
+    const long long MAX_CREDIT_SCALE = 100;
+    size_t n = planned.size();
+    double plannedCredits = 0.0;
+    for (const auto& course : planned) plannedCredits += course.credit;
+
+    // Credits are scaled by the smallest common denominator that makes them all whole (up to hundredths).
+    long long scale = 1;
+    auto whole = [&](long long candidate) {
+        for (const auto& course : planned) {
+            double units = course.credit * (double)candidate;
+            if (fabs(units - nearbyint(units)) > 1e-9 * max(1.0, units)) return false;
+        }
+        return true;
+    };
+    while (scale < MAX_CREDIT_SCALE && !whole(scale)) ++scale;
+
+    vector<size_t> creditUnits(n);
+    size_t maxUnits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        creditUnits[i] = (size_t)max(1LL, llround(planned[i].credit * (double)scale));
+        maxUnits += creditUnits[i] * TOP_LEVEL;
+    }
+
+    // A course of u credit units at level k earns u * k units, each worth 0.5 / scale credit-weighted grade points.
+    double neededPoints = targetGPA * (currentCredits + plannedCredits) - currentPoints;
+    long long required = max(0LL, (long long)ceil(neededPoints * 2 * (double)scale - 1e-9));
+
+    vector<uint8_t> highest(maxUnits + 1, UNREACHABLE), next(maxUnits + 1);
+    vector<vector<uint8_t>> choice(n, vector<uint8_t>(maxUnits + 1, 0));
+    highest[0] = 0;
+    size_t reach = 0;
+    for (size_t i = 0; i < n; ++i) {
+        fill(next.begin(), next.end(), UNREACHABLE);
+        for (size_t s = 0; s <= reach; ++s) {
+            if (highest[s] == UNREACHABLE) continue;
+            for (int level = 0; level <= TOP_LEVEL; ++level) {
+                size_t t = s + creditUnits[i] * level;
+                uint8_t cost = max<uint8_t>(highest[s], (uint8_t)level);
+                if (cost < next[t]) {
+                    next[t] = cost;
+                    choice[i][t] = (uint8_t)level;
+                }
+            }
+        }
+        reach += creditUnits[i] * TOP_LEVEL;
+        highest.swap(next);
+    }
+
+    GradePlan plan;
+    size_t best = maxUnits;
+    plan.reachable = (size_t)required <= maxUnits;
+    if (plan.reachable) {
+        uint8_t bestCost = UNREACHABLE;
+        for (size_t s = (size_t)required; s <= maxUnits; ++s) {
+            if (highest[s] < bestCost) {
+                bestCost = highest[s];
+                best = s;
+            }
+        }
+    }
+
+    plan.grades.resize(n);
+    for (size_t i = n, s = best; i-- > 0;) {
+        int level = choice[i][s];
+        plan.grades[i] = (Grade)(TOP_LEVEL - level);
+        s -= creditUnits[i] * level;
+    }
+    double totalPoints = currentPoints, totalCredits = currentCredits + plannedCredits;
+    for (size_t i = 0; i < n; ++i) totalPoints += gradePoint(plan.grades[i]) * planned[i].credit;
+    plan.projectedGPA = totalCredits > 0 ? totalPoints / totalCredits : 0.0;
+    plan.reachable = plan.projectedGPA >= targetGPA - 1e-9;
+    return plan;
+}
+
+class CourseJournal {
+private:
+    string snapshotFile;
+    string journalFile;
+    vector<Course> courses;
+    unordered_map<string, size_t> indexByCode;
+    double totalPoints = 0.0;
+    double totalCredits = 0.0;
+    size_t pendingEvents = 0;
+    ofstream journal;
+    static const size_t COMPACT_AFTER_EVENTS = 256;
+
+    void rebuildTotals() {
+        indexByCode.clear();
+        totalPoints = totalCredits = 0.0;
+        for (size_t i = 0; i < courses.size(); ++i) {
+            indexByCode[courses[i].code] = i;
+            totalPoints += gradePoint(courses[i].grade) * courses[i].credit;
+            totalCredits += courses[i].credit;
+        }
+    }
+
+    bool applyAdd(const Course& c) {
+        if (!indexByCode.emplace(c.code, courses.size()).second) return false;
+        courses.push_back(c);
+        totalPoints += gradePoint(c.grade) * c.credit;
+        totalCredits += c.credit;
+        return true;
+    }
+
+    bool applyUpdate(const string& code, Grade grade) {
+        auto it = indexByCode.find(code);
+        if (it == indexByCode.end()) return false;
+        Course& c = courses[it->second];
+        totalPoints += (gradePoint(grade) - gradePoint(c.grade)) * c.credit;
+        c.grade = grade;
+        return true;
+    }
+
+    bool applyRemove(const string& code) {
+        auto it = indexByCode.find(code);
+        if (it == indexByCode.end()) return false;
+        size_t slot = it->second;
+        totalPoints -= gradePoint(courses[slot].grade) * courses[slot].credit;
+        totalCredits -= courses[slot].credit;
+        indexByCode.erase(it);
+        if (slot != courses.size() - 1) {
+            courses[slot] = move(courses.back());
+            indexByCode[courses[slot].code] = slot;
+        }
+        courses.pop_back();
+        return true;
+    }
+
+    bool applyEvent(string_view entry) {
+        if (entry.size() < 3 || entry[1] != ',') return false;
+        string_view body = entry.substr(2);
+        if (entry[0] == 'A') {
+            size_t p1 = body.find(','), p2 = body.find(',', p1 + 1), p3 = body.find(',', p2 + 1);
+            if (p3 == string_view::npos) return false;
+            Course c;
+            string_view creditField = body.substr(p1 + 1, p2 - p1 - 1);
+            if (!parseCredit(creditField, c.credit)) return false;
+            if (!parseGrade(body.substr(p2 + 1, p3 - p2 - 1), c.grade)) return false;
+            c.code.assign(body.substr(0, p1));
+            c.name.assign(body.substr(p3 + 1));
+            applyAdd(c);
+        }
+        else if (entry[0] == 'U') {
+            size_t p1 = body.find(',');
+            Grade grade;
+            if (p1 == string_view::npos || !parseGrade(body.substr(p1 + 1), grade)) return false;
+            applyUpdate(string(body.substr(0, p1)), grade);
+        }
+        else if (entry[0] == 'R') {
+            applyRemove(string(body));
+        }
+        else return false;
+        return true;
+    }
+
+    bool replay() {
+        MappedFile file(journalFile);
+        string_view data = file.contents();
+        while (!data.empty()) {
+            size_t end = data.find('\n');
+            if (end == string_view::npos) return false;
+            string_view record = data.substr(0, end);
+            size_t bar = record.rfind('|');
+            uint32_t crc = 0;
+            if (bar == string_view::npos || record.size() - bar - 1 != 8
+                || from_chars(record.data() + bar + 1, record.data() + end, crc, 16).ptr != record.data() + end
+                || crc32(record.substr(0, bar)) != crc || !applyEvent(record.substr(0, bar))) return false;
+            data.remove_prefix(end + 1);
+            ++pendingEvents;
+        }
+        return true;
+    }
+
+    void appendEvent(const string& entry) {
+        char crc[16];
+        snprintf(crc, sizeof(crc), "|%08x\n", crc32(entry));
+        journal << entry << crc;
+        journal.flush();
+        if (++pendingEvents >= COMPACT_AFTER_EVENTS) compact();
+    }
+
+public:
+    CourseJournal(const string& snapshot = "courses.txt", const string& log = "courses.journal")
+        : snapshotFile(snapshot), journalFile(log) {}
+
+    void open() {
+        courses = loadCoursesFromFile(snapshotFile);
+        rebuildTotals();
+        pendingEvents = 0;
+        bool clean = replay();
+        journal.close();
+        if (clean) {
+            journal.open(journalFile, ios::app);
+            return;
+        }
+        cerr << YELLOW << "Discarding a damaged or incomplete record in " << journalFile << " and everything after it." << RESET << endl;
+        compact();
+    }
+
+    bool addCourse(const Course& c) {
+        if (!applyAdd(c)) return false;
+        ostringstream entry;
+        entry << "A," << c.code << "," << c.credit << "," << gradeName(c.grade) << "," << c.name;
+        appendEvent(entry.str());
+        return true;
+    }
+
+    bool updateGrade(const string& code, Grade grade) {
+        if (!applyUpdate(code, grade)) return false;
+        appendEvent("U," + code + "," + gradeName(grade));
+        return true;
+    }
+
+    bool removeCourse(const string& code) {
+        if (!applyRemove(code)) return false;
+        appendEvent("R," + code);
+        return true;
+    }
+
+    void replaceAll(const vector<Course>& replacement) {
+        courses = replacement;
+        rebuildTotals();
+        compact();
+    }
+
+    void compact() {
+        string temporary = snapshotFile + ".tmp";
+#ifdef _WIN32
+        bool replaced = saveCoursesToFile(courses, temporary)
+            && MoveFileExA(temporary.c_str(), snapshotFile.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        bool replaced = saveCoursesToFile(courses, temporary) && rename(temporary.c_str(), snapshotFile.c_str()) == 0;
+#endif
+        if (!replaced) throw runtime_error("Cannot write " + snapshotFile + "; keeping " + journalFile);
+        journal.close();
+        journal.open(journalFile, ios::trunc);
+        pendingEvents = 0;
+        rebuildTotals();
+    }
+
+    const vector<Course>& all() const { return courses; }
+    double points() const { return totalPoints; }
+    double credits() const { return totalCredits; }
+    double gpa() const { return totalCredits > 0 ? totalPoints / totalCredits : 0.0; }
+};
+
+Course promptCourse() {
+    Course c;
+    string input;
+    while (true) {
+        cout << "Course code: ";
+        getline(cin, c.code);
+        if (!c.code.empty() && c.code.find(',') == string::npos) break;
+        cerr << RED << "Course codes cannot be empty or contain commas." << RESET << endl;
+    }
+    cout << "Course name: ";
+    getline(cin, c.name);
+
+    while (true) {
+        cout << "Course credit: ";
+        getline(cin, input);
+        try {
+            c.credit = stod(input);
+            if (c.credit > 0) break;
+        }
+        catch (...) {}
+        cerr << RED << "Invalid credit. Please enter a valid number." << RESET << endl;
+    }
+
+    while (true) {
+        cout << "Letter grade (";
+        for (size_t g = 0; g < GRADE_COUNT; ++g) cout << gradeNames[g] << (g + 1 == GRADE_COUNT ? "): " : "/");
+        getline(cin, input);
+        if (parseGrade(input, c.grade)) break;
+        cerr << RED << "Invalid grade. Try again." << RESET << endl;
+    }
+    return c;
 }
 
 vector<Course> getCourses() {
@@ -107,76 +690,137 @@ vector<Course> getCourses() {
     }
 
     for (int i = 0; i < n; ++i) {
-        Course c;
         cout << BLUE << "\nCourse " << (i + 1) << RESET << endl;
-        cout << "Course code: ";
-        getline(cin, c.code);
-        cout << "Course name: ";
-        getline(cin, c.name);
+        courses.push_back(promptCourse());
+    }
+    return courses;
+}
 
+void planInteractively(const CourseJournal& journal) {
+    string input;
+    double target;
+    int n;
+    try {
+        cout << "Target GPA: ";
+        getline(cin, input);
+        target = stod(input);
+        cout << "Number of planned courses: ";
+        getline(cin, input);
+        n = stoi(input);
+        if (target < 0 || target > 4 || n <= 0) throw invalid_argument("range");
+    }
+    catch (...) {
+        cerr << RED << "Invalid target or course count." << RESET << endl;
+        return;
+    }
+
+    vector<PlannedCourse> planned(n);
+    for (int i = 0; i < n; ++i) {
+        cout << BLUE << "Planned course " << (i + 1) << RESET << " code: ";
+        getline(cin, planned[i].code);
         while (true) {
-            cout << "Course credit: ";
+            cout << "Credit: ";
             getline(cin, input);
             try {
-                c.credit = stod(input);
-                if (c.credit > 0) break;
+                planned[i].credit = stod(input);
+                if (planned[i].credit > 0) break;
             }
             catch (...) {}
             cerr << RED << "Invalid credit. Please enter a valid number." << RESET << endl;
         }
+    }
 
-        while (true) {
-            cout << "Letter grade (";
-            for (const auto& g : validGrades) cout << g << (g == "FF" ? "): " : "/");
-            getline(cin, c.letterGrade);
-            transform(c.letterGrade.begin(), c.letterGrade.end(), c.letterGrade.begin(), ::toupper);
-            if (isValidGrade(c.letterGrade)) break;
-            cerr << RED << "Invalid grade. Try again." << RESET << endl;
-        }
-
-        courses.push_back(c);
+    GradePlan plan = planGrades(journal.points(), journal.credits(), planned, target);
+    if (!plan.reachable) {
+        cerr << RED << "A GPA of " << fixed << setprecision(2) << target << " is out of reach; even all AA gives "
+            << plan.projectedGPA << "." << RESET << endl;
+        return;
     }
-    return courses;
+    cout << BOLD << left << setw(10) << "Code" << setw(7) << "Credit" << "Needed" << RESET << endl;
+    for (int i = 0; i < n; ++i) {
+        cout << left << setw(10) << planned[i].code << setw(7) << planned[i].credit << gradeName(plan.grades[i]) << endl;
+    }
+    cout << YELLOW << "Projected GPA: " << fixed << setprecision(2) << plan.projectedGPA << RESET << endl;
 }
 
-void interactiveMode(vector<Course>& courses) {
+double interactiveMode(vector<Course>& courses, CourseJournal& journal) {
     string input;
+    journal.open();
     while (true) {
         cout << BOLD << CYAN << "\nChoose an option:" << RESET << endl;
         cout << " 1. Enter new courses" << endl;
         cout << " 2. View previously saved courses" << endl;
-        cout << " 3. Exit" << endl;
-        cout << "Enter choice [1-3]: ";
+        cout << " 3. Add a course" << endl;
+        cout << " 4. Update a course grade" << endl;
+        cout << " 5. Remove a course" << endl;
+        cout << " 6. Plan grades for a target GPA" << endl;
+        cout << " 7. Export saved courses to binary store (courses.bin)" << endl;
+        cout << " 8. View courses from binary store" << endl;
+        cout << " 9. Exit" << endl;
+        cout << "Enter choice [1-9]: ";
         getline(cin, input);
 
         if (input == "1") {
-            courses = getCourses();
-            saveCoursesToFile(courses, "courses.txt");
-            break;
+            journal.replaceAll(getCourses());
+            courses = journal.all();
+            return journal.gpa();
         }
         else if (input == "2") {
-            courses = loadCoursesFromFile("courses.txt");
-            break;
+            courses = journal.all();
+            return journal.gpa();
         }
         else if (input == "3") {
+            Course c = promptCourse();
+            if (journal.addCourse(c)) cout << GREEN << "Course added." << RESET << endl;
+            else cerr << RED << "A course with code " << c.code << " already exists." << RESET << endl;
+        }
+        else if (input == "4" || input == "5") {
+            string code;
+            cout << "Course code: ";
+            getline(cin, code);
+            bool done;
+            if (input == "4") {
+                Grade grade;
+                cout << "New letter grade: ";
+                getline(cin, input);
+                if (!parseGrade(input, grade)) {
+                    cerr << RED << "Invalid grade." << RESET << endl;
+                    continue;
+                }
+                done = journal.updateGrade(code, grade);
+            }
+            else {
+                done = journal.removeCourse(code);
+            }
+            if (done) cout << GREEN << "Saved." << RESET << endl;
+            else cerr << RED << "No course with code " << code << "." << RESET << endl;
+        }
+        else if (input == "6") {
+            planInteractively(journal);
+            continue;
+        }
+        else if (input == "7") {
+            saveCoursesToBinary(journal.all(), "courses.bin");
+            cout << GREEN << "Exported " << journal.all().size() << " courses to courses.bin" << RESET << endl;
+        }
+        else if (input == "8") {
+            double gpa = 0.0;
+            if (loadCoursesFromBinary("courses.bin", courses, gpa)) return gpa;
+            cerr << RED << "courses.bin is missing or corrupt." << RESET << endl;
+        }
+        else if (input == "9") {
             cout << RED << "Exiting program..." << RESET << endl;
             exit(0);
         }
         else {
-            cerr << RED << "Invalid input. Please select 1, 2 or 3." << RESET << endl;
+            cerr << RED << "Invalid input. Please select 1-9." << RESET << endl;
+            continue;
         }
+        cout << YELLOW << "Current GPA: " << fixed << setprecision(2) << journal.gpa()
+            << " over " << journal.credits() << " credits" << RESET << endl;
     }
 }
 
-double calculateGPA(const vector<Course>& courses) {
-    double totalPoints = 0.0, totalCredits = 0.0;
-    for (const auto& c : courses) {
-        totalPoints += gradePointMap[c.letterGrade] * c.credit;
-        totalCredits += c.credit;
-    }
-    return (totalCredits > 0) ? (totalPoints / totalCredits) : 0.0;
-}
-
 string gpaClassification(double gpa) {
     if (gpa >= 3.5) return "High Honors";
     if (gpa >= 3.0) return "Honors";
@@ -184,6 +828,155 @@ string gpaClassification(double gpa) {
     return "Fail";
 }
 
+void runOnThreadPool(size_t taskCount, const function<void(size_t)>& task) {
+    size_t workers = min<size_t>(max(1u, thread::hardware_concurrency()), max<size_t>(taskCount, 1));
+    atomic<size_t> next{ 0 };
+    vector<thread> pool;
+    for (size_t w = 0; w < workers; ++w) {
+        pool.emplace_back([&]() {
+            for (size_t t = next++; t < taskCount; t = next++) task(t);
+        });
+    }
+    for (auto& t : pool) t.join();
+}
+
+struct TranscriptRecord {
+    string_view studentId;
+    string_view term;
+    double credit;
+    Grade grade;
+};
+
+struct TermTotals {
+    string_view term;
+    double points;
+    double credits;
+};
+
+struct BulkSummary {
+    size_t records = 0;
+    size_t skipped = 0;
+    size_t students = 0;
+};
+
+bool parseTranscriptLine(string_view line, TranscriptRecord& r) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    string_view fields[3];
+    for (int f = 0; f < 3; ++f) {
+        size_t comma = line.find(',');
+        if (comma == string_view::npos) return false;
+        fields[f] = line.substr(0, comma);
+        line.remove_prefix(comma + 1);
+    }
+    size_t gradeComma = line.rfind(',');
+    if (gradeComma == string_view::npos || gradeComma == 0) return false;
+    size_t creditComma = line.rfind(',', gradeComma - 1);
+    if (creditComma == string_view::npos) return false;
+
+    string_view creditField = line.substr(creditComma + 1, gradeComma - creditComma - 1);
+    if (!parseCredit(creditField, r.credit) || r.credit <= 0 || fields[0].empty()) return false;
+    if (!parseGrade(line.substr(gradeComma + 1), r.grade)) return false;
+    r.studentId = fields[0];
+    r.term = fields[1];
+    return true;
+}
+
+void appendStudentResult(string& out, string_view studentId, vector<TermTotals>& terms, size_t courses) {
+    sort(terms.begin(), terms.end(), [](const TermTotals& a, const TermTotals& b) { return a.term < b.term; });
+    double points = 0.0, credits = 0.0;
+    string history;
+    char number[32];
+    for (const auto& t : terms) {
+        points += t.points;
+        credits += t.credits;
+        auto written = to_chars(number, number + sizeof(number), credits > 0 ? points / credits : 0.0, chars_format::fixed, 2);
+        if (!history.empty()) history += '|';
+        history.append(t.term).append("=").append(number, written.ptr);
+    }
+    double gpa = credits > 0 ? points / credits : 0.0;
+    out.append(studentId).append(",").append(to_string(courses)).append(",");
+    out.append(number, to_chars(number, number + sizeof(number), credits, chars_format::general).ptr).append(",");
+    out.append(number, to_chars(number, number + sizeof(number), gpa, chars_format::fixed, 2).ptr).append(",");
+    out.append(gpaClassification(gpa)).append(",").append(history).append("\n");
+}
+
+BulkSummary runBulkTranscripts(const string& inputFile, const string& outputFile) {
+    const size_t partitionCount = 64;
+    BulkSummary summary;
+    MappedFile file(inputFile);
+    string_view data = file.contents();
+    if (data.empty()) throw runtime_error("Cannot read transcripts from " + inputFile);
+
+    size_t chunkCount = max(1u, thread::hardware_concurrency()) * 4;
+    vector<size_t> bounds = { 0 };
+    for (size_t c = 1; c < chunkCount; ++c) {
+        size_t cut = data.find('\n', max(bounds.back(), data.size() * c / chunkCount));
+        if (cut == string_view::npos) break;
+        bounds.push_back(cut + 1);
+    }
+    bounds.push_back(data.size());
+    chunkCount = bounds.size() - 1;
+
+    vector<vector<vector<TranscriptRecord>>> buckets(chunkCount, vector<vector<TranscriptRecord>>(partitionCount));
+    vector<size_t> skipped(chunkCount, 0);
+    runOnThreadPool(chunkCount, [&](size_t c) {
+        string_view chunk = data.substr(bounds[c], bounds[c + 1] - bounds[c]);
+        hash<string_view> hasher;
+        while (!chunk.empty()) {
+            size_t end = chunk.find('\n');
+            string_view line = chunk.substr(0, end);
+            chunk.remove_prefix(end == string_view::npos ? chunk.size() : end + 1);
+            TranscriptRecord r;
+            if (parseTranscriptLine(line, r)) buckets[c][hasher(r.studentId) % partitionCount].push_back(r);
+            else if (!line.empty() && line != "\r") skipped[c]++;
+        }
+    });
+
+    vector<string> results(partitionCount);
+    vector<size_t> studentCounts(partitionCount, 0), recordCounts(partitionCount, 0);
+    runOnThreadPool(partitionCount, [&](size_t p) {
+        unordered_map<string_view, size_t> index;
+        vector<string_view> order;
+        vector<vector<TermTotals>> terms;
+        vector<size_t> courseCounts;
+        for (size_t c = 0; c < chunkCount; ++c) {
+            for (const auto& r : buckets[c][p]) {
+                auto found = index.emplace(r.studentId, order.size());
+                if (found.second) {
+                    order.push_back(r.studentId);
+                    terms.emplace_back();
+                    courseCounts.push_back(0);
+                }
+                size_t s = found.first->second;
+                courseCounts[s]++;
+                auto& studentTerms = terms[s];
+                auto t = find_if(studentTerms.begin(), studentTerms.end(), [&](const TermTotals& x) { return x.term == r.term; });
+                if (t == studentTerms.end()) studentTerms.push_back({ r.term, 0.0, 0.0 });
+                else if (t != studentTerms.end() - 1) swap(*t, studentTerms.back());
+                studentTerms.back().points += gradePoint(r.grade) * r.credit;
+                studentTerms.back().credits += r.credit;
+            }
+            recordCounts[p] += buckets[c][p].size();
+            vector<TranscriptRecord>().swap(buckets[c][p]);
+        }
+        for (size_t s = 0; s < order.size(); ++s) appendStudentResult(results[p], order[s], terms[s], courseCounts[s]);
+        studentCounts[p] = order.size();
+    });
+
+    ofstream out(outputFile, ios::binary | ios::trunc);
+    if (!out) throw runtime_error("Cannot write results to " + outputFile);
+    out << "studentId,courses,credits,gpa,classification,cumulativeByTerm\n";
+    for (const auto& chunk : results) out.write(chunk.data(), (streamsize)chunk.size());
+    out.close();
+
+    for (size_t p = 0; p < partitionCount; ++p) {
+        summary.students += studentCounts[p];
+        summary.records += recordCounts[p];
+    }
+    for (size_t s : skipped) summary.skipped += s;
+    return summary;
+}
+
 void renderCourseTable(const vector<Course>& courses) {
     cout << line('-') << endl;
     cout << BOLD << left << setw(10) << "Code"
@@ -197,15 +990,43 @@ void renderCourseTable(const vector<Course>& courses) {
     cout << line('-') << endl;
 }
 
-int main() {
+#ifndef GPA_NO_MAIN
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bulk") {
+        if (argc != 4) {
+            cerr << "Usage: " << argv[0] << " --bulk <transcripts.csv> <results.csv>" << endl;
+            cerr << "Transcript lines: studentId,term,code,name,credit,grade" << endl;
+            return 1;
+        }
+        try {
+            auto start = chrono::steady_clock::now();
+            BulkSummary summary = runBulkTranscripts(argv[2], argv[3]);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << GREEN << "Processed " << summary.records << " course records for " << summary.students
+                << " students in " << fixed << setprecision(2) << seconds << "s" << RESET << endl;
+            if (summary.skipped > 0) cout << YELLOW << "Skipped " << summary.skipped << " malformed lines" << RESET << endl;
+        }
+        catch (const exception& ex) {
+            cerr << RED << "Error: " << ex.what() << RESET << endl;
+            return 1;
+        }
+        return 0;
+    }
+
     clearScreen();
     cout << BOLD << GREEN << "\nWelcome to the Grade Point Average Calculation System" << RESET << endl;
     cout << line('=') << endl;
 
     vector<Course> courses;
-    interactiveMode(courses);
-
-    double gpa = calculateGPA(courses);
+    CourseJournal journal;
+    double gpa = 0.0;
+    try {
+        gpa = interactiveMode(courses, journal);
+    }
+    catch (const exception& ex) {
+        cerr << RED << "Error: " << ex.what() << RESET << endl;
+        return 1;
+    }
 
     clearScreen();
     cout << BOLD << CYAN << "\nCourse Summary" << RESET << endl;
@@ -217,3 +1038,4 @@ int main() {
     cout << BOLD << RED << "\n\nAZD" << RESET << endl;
     return 0;
 }
+#endif
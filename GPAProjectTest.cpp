@@ -0,0 +1,136 @@
+// File: GPAProjectTest.cpp
+// Build: g++ -O2 -std=c++17 GPAProjectTest.cpp -o gpa_test -pthread
+#define GPA_NO_MAIN
+#include "GPAProject.cpp"
+
+#include <cstdio>
+
+using namespace std;
+
+int failures = 0;
+
+void check(bool condition, const string& what) {
+    if (condition) return;
+    cerr << "FAILED: " << what << endl;
+    ++failures;
+}
+
+void removeTestFiles(const string& snapshot, const string& log) {
+    for (const string& file : { snapshot, snapshot + ".tmp", log }) remove(file.c_str());
+}
+
+void testCommaInNameSurvivesCompaction() {
+    const string snapshot = "gpa_test_courses.txt", log = "gpa_test_courses.journal";
+    removeTestFiles(snapshot, log);
+    {
+        CourseJournal journal(snapshot, log);
+        journal.open();
+        journal.addCourse({ "MATH201", "Math, advanced", 4.0, Grade::BB });
+        journal.addCourse({ "PHYS101", "Physics", 3.0, Grade::CC });
+        for (int i = 0; i < 300; ++i) journal.updateGrade("MATH201", i % 2 ? Grade::AA : Grade::BA);
+    }
+    CourseJournal reopened(snapshot, log);
+    reopened.open();
+    check(reopened.all().size() == 2, "both courses survive compaction");
+    bool found = false;
+    for (const auto& c : reopened.all()) {
+        if (c.code == "MATH201") {
+            found = true;
+            check(c.name == "Math, advanced", "course name keeps its comma");
+            check(c.credit == 4.0 && c.grade == Grade::AA, "credit and grade survive compaction");
+        }
+    }
+    check(found, "course with a comma in its name is found after reload");
+    removeTestFiles(snapshot, log);
+}
+
+string readFile(const string& filename) {
+    ifstream in(filename, ios::binary);
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+void testDamagedJournalStopsReplay() {
+    const string snapshot = "gpa_test_damaged.txt", log = "gpa_test_damaged.journal";
+    removeTestFiles(snapshot, log);
+    {
+        CourseJournal journal(snapshot, log);
+        journal.open();
+        journal.addCourse({ "CHEM101", "Chemistry", 3.0, Grade::BB });
+        journal.addCourse({ "BIO101", "Biology", 2.0, Grade::CC });
+        journal.updateGrade("CHEM101", Grade::AA);
+    }
+    string contents = readFile(log);
+    size_t second = contents.find("BIO101");
+    check(second != string::npos, "journal holds the second record");
+    contents[second] = 'X';
+    ofstream(log, ios::binary | ios::trunc) << contents;
+
+    {
+        CourseJournal reopened(snapshot, log);
+        reopened.open();
+        check(reopened.all().size() == 1 && reopened.all()[0].code == "CHEM101", "replay stops at the damaged record");
+        check(reopened.all()[0].grade == Grade::BB, "records after the damaged one are not applied");
+        check(readFile(log).empty(), "journal is truncated at the damaged record");
+        reopened.addCourse({ "HIST101", "History", 2.0, Grade::AA });
+    }
+    ofstream(log, ios::binary | ios::app) << "U,HIST101,FF";
+
+    CourseJournal torn(snapshot, log);
+    torn.open();
+    check(torn.all().size() == 2, "records before a torn tail survive");
+    check(torn.all().size() == 2 && torn.all()[1].grade == Grade::AA, "torn record is discarded");
+    removeTestFiles(snapshot, log);
+}
+
+void testCreditMustBeWholeField() {
+    Course c;
+    check(parseCourseLine("CS101,Intro,3,AA", c) && c.credit == 3.0, "plain credit parses");
+    check(!parseCourseLine("CS101,Intro,3.5abc,AA", c), "credit with trailing letters is rejected");
+    check(!parseCourseLine("CS101,Intro,3 ,AA", c), "credit with a trailing space is rejected");
+}
+
+void testTranscriptNameMayContainCommas() {
+    TranscriptRecord r;
+    check(parseTranscriptLine("S1,2024F,MATH201,Math, advanced,4,BA", r), "transcript line with a comma in the name parses");
+    check(r.studentId == "S1" && r.term == "2024F", "student and term come from the left");
+    check(r.credit == 4.0 && r.grade == Grade::BA, "credit and grade come from the right");
+    check(parseTranscriptLine("S2,2024S,PHYS101,Physics,3.5,CC\r", r) && r.credit == 3.5 && r.grade == Grade::CC, "plain transcript line parses");
+    check(!parseTranscriptLine("S3,2024S,PHYS101,3,CC", r), "transcript line without a name field is rejected");
+    check(!parseTranscriptLine("S4,2024S,PHYS101,Physics,3.5abc,CC", r), "credit with trailing garbage is rejected");
+}
+
+void testBinaryStoreGPAMatchesCourses() {
+    const string store = "gpa_test_courses.bin";
+    vector<Course> courses;
+    for (int i = 0; i < 37; ++i) courses.push_back({ "C" + to_string(i), "Course", 0.5 + (i % 7) * 0.75, (Grade)(i % GRADE_COUNT) });
+    saveCoursesToBinary(courses, store);
+    vector<Course> loaded;
+    double gpa = -1.0;
+    check(loadCoursesFromBinary(store, loaded, gpa) && loaded.size() == courses.size(), "binary store round-trips");
+    check(fabs(gpa - calculateGPA(courses)) < 1e-9, "column GPA matches the per-course GPA");
+    check(calculateGPA(static_cast<const uint8_t*>(nullptr), nullptr, 0) == 0.0, "empty columns give a zero GPA");
+    remove(store.c_str());
+}
+
+void testPlannerUsesExactCredits() {
+    GradePlan plan = planGrades(20, 10, { { "X", 1.2 } }, 2.2);
+    check(plan.reachable, "1.2-credit course can lift 20/10 to 2.2");
+    check(plan.grades.size() == 1 && plan.grades[0] == Grade::AA, "planner needs AA for the 1.2-credit course");
+    check(fabs(plan.projectedGPA - 24.8 / 11.2) < 1e-9, "projected GPA uses the real credits");
+
+    plan = planGrades(30, 10, { { "Y", 0.3 }, { "Z", 2.75 } }, 3.0);
+    check(plan.reachable && plan.projectedGPA >= 3.0 - 1e-9, "fractional credits reach an attainable target");
+    double points = 30 + gradePoint(plan.grades[0]) * 0.3 + gradePoint(plan.grades[1]) * 2.75;
+    check(fabs(plan.projectedGPA - points / 13.05) < 1e-9, "projected GPA matches the chosen grades");
+}
+
+int main() {
+    testCommaInNameSurvivesCompaction();
+    testDamagedJournalStopsReplay();
+    testCreditMustBeWholeField();
+    testTranscriptNameMayContainCommas();
+    testBinaryStoreGPAMatchesCourses();
+    testPlannerUsesExactCredits();
+    if (failures == 0) cout << "All GPA tests passed." << endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -5,15 +5,292 @@
 #include <string>
 #include <map>
 #include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cmath>
+#include <unordered_map>
+#include <string_view>
+#include <charconv>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <array>
+#include <cstring>
+#include <cstdio>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
+class MappedFile {
+private:
+    const char* view = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const string& filename) {
+#ifdef _WIN32
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (view) length = (size_t)size.QuadPart;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                view = static_cast<const char*>(p);
+                length = (size_t)st.st_size;
+                madvise(p, length, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (view) munmap(const_cast<char*>(view), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return view != nullptr; }
+    string_view contents() const { return string_view(view ? view : "", length); }
+};
+
+class QuantileSketch {
+private:
+    size_t k;
+    size_t itemCount = 0;
+    size_t sizeLimit = 0;
+    uint64_t totalWeight = 0;
+    uint64_t randomState = 0x9E3779B97F4A7C15ULL;
+    vector<vector<double>> levels;
+    mutable vector<double> sortedValues;
+    mutable vector<uint64_t> cumulativeWeights;
+    mutable bool cacheValid = false;
+
+    size_t capacity(size_t level) const {
+        size_t depth = levels.size() - 1 - level;
+        return max<size_t>(2, (size_t)ceil(k * pow(2.0 / 3.0, (double)depth)));
+    }
+
+    void updateSizeLimit() {
+        sizeLimit = 0;
+        for (size_t h = 0; h < levels.size(); ++h) sizeLimit += capacity(h);
+    }
+
+    bool randomBit() {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 7;
+        randomState ^= randomState << 17;
+        return randomState & 1;
+    }
+
+    void compress() {
+        while (itemCount >= sizeLimit) {
+            for (size_t h = 0; h < levels.size(); ++h) {
+                if (levels[h].size() < capacity(h)) continue;
+                if (h + 1 == levels.size()) {
+                    levels.emplace_back();
+                    updateSizeLimit();
+                }
+                vector<double>& level = levels[h];
+                sort(level.begin(), level.end());
+                double heldBack = level.back();
+                bool odd = level.size() % 2 == 1;
+                if (odd) level.pop_back();
+                for (size_t i = randomBit() ? 1 : 0; i < level.size(); i += 2) levels[h + 1].push_back(level[i]);
+                itemCount -= level.size() / 2;
+                level.clear();
+                if (odd) level.push_back(heldBack);
+                break;
+            }
+        }
+    }
+
+    void buildCache() const {
+        vector<pair<double, uint64_t>> weighted;
+        for (size_t h = 0; h < levels.size(); ++h) {
+            for (double value : levels[h]) weighted.push_back({ value, 1ULL << h });
+        }
+        sort(weighted.begin(), weighted.end());
+        sortedValues.resize(weighted.size());
+        cumulativeWeights.resize(weighted.size());
+        uint64_t running = 0;
+        for (size_t i = 0; i < weighted.size(); ++i) {
+            running += weighted[i].second;
+            sortedValues[i] = weighted[i].first;
+            cumulativeWeights[i] = running;
+        }
+        cacheValid = true;
+    }
+
+public:
+    explicit QuantileSketch(size_t accuracy = 200) : k(accuracy), levels(1) {
+        updateSizeLimit();
+    }
+
+    void add(double value) {
+        levels[0].push_back(value);
+        itemCount++;
+        totalWeight++;
+        cacheValid = false;
+        if (itemCount >= sizeLimit) compress();
+    }
+
+    void merge(const QuantileSketch& other) {
+        if (other.levels.size() > levels.size()) {
+            levels.resize(other.levels.size());
+            updateSizeLimit();
+        }
+        for (size_t h = 0; h < other.levels.size(); ++h) {
+            levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+            itemCount += other.levels[h].size();
+        }
+        totalWeight += other.totalWeight;
+        cacheValid = false;
+        compress();
+    }
+
+    double quantile(double q) const {
+        if (totalWeight == 0) return numeric_limits<double>::quiet_NaN();
+        if (!cacheValid) buildCache();
+        uint64_t rank = (uint64_t)ceil(max(0.0, min(1.0, q)) * (double)cumulativeWeights.back());
+        size_t index = (size_t)(lower_bound(cumulativeWeights.begin(), cumulativeWeights.end(), max<uint64_t>(rank, 1)) - cumulativeWeights.begin());
+        return sortedValues[min(index, sortedValues.size() - 1)];
+    }
+};
+
+struct ScoreStatistics {
+    static constexpr int BINS = 20;
+    static constexpr double BIN_WIDTH = 100.0 / BINS;
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double minimum = numeric_limits<double>::infinity();
+    double maximum = -numeric_limits<double>::infinity();
+    array<uint64_t, BINS> histogram{};
+    QuantileSketch sketch;
+
+    void add(double value) {
+        if (value != value) return;
+        count++;
+        double delta = value - mean;
+        mean += delta / (double)count;
+        m2 += delta * (value - mean);
+        minimum = min(minimum, value);
+        maximum = max(maximum, value);
+        histogram[(size_t)max(0, min(BINS - 1, (int)(value / BIN_WIDTH)))]++;
+        sketch.add(value);
+    }
+
+    void merge(const ScoreStatistics& other) {
+        if (other.count == 0) return;
+        uint64_t total = count + other.count;
+        double delta = other.mean - mean;
+        m2 += other.m2 + delta * delta * (double)count * (double)other.count / (double)total;
+        mean += delta * (double)other.count / (double)total;
+        count = total;
+        minimum = min(minimum, other.minimum);
+        maximum = max(maximum, other.maximum);
+        for (int b = 0; b < BINS; ++b) histogram[b] += other.histogram[b];
+        sketch.merge(other.sketch);
+    }
+
+    double variance() const { return count > 1 ? m2 / (double)(count - 1) : 0.0; }
+    double standardDeviation() const { return sqrt(variance()); }
+    double percentile(double p) const { return sketch.quantile(p / 100.0); }
+    double median() const { return percentile(50.0); }
+};
+
+uint32_t crc32(const char* data, size_t size, uint32_t crc = 0) {
+    static const auto tables = []() {
+        array<array<uint32_t, 256>, 8> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (size_t s = 1; s < 8; ++s) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+        }
+        return t;
+    }();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    crc = ~crc;
+    while (size >= 8) {
+        uint32_t low = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+        crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+            ^ tables[3][p[4]] ^ tables[2][p[5]] ^ tables[1][p[6]] ^ tables[0][p[7]];
+        p += 8;
+        size -= 8;
+    }
+    while (size--) crc = tables[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+const char SNAPSHOT_MAGIC[4] = { 'G', 'C', 'S', 'N' };
+const uint32_t SNAPSHOT_VERSION = 1;
+
+enum SnapshotSection : uint32_t {
+    SECTION_CONFIG = 1,
+    SECTION_NAMES,
+    SECTION_ROW_SUMS,
+    SECTION_ROW_WEIGHTS,
+    SECTION_AVERAGES,
+    SECTION_GRADE_IDS,
+    SECTION_COLUMN
+};
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t studentCount;
+    uint32_t subjectCount;
+    uint32_t sectionCount;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct SnapshotSectionEntry {
+    uint32_t id;
+    uint32_t crc;
+    uint64_t offset;
+    uint64_t size;
+};
+
 struct Student {
     string name;
     string surname;
     map<string, double> subjectGrades;
     double averageGrade;
     string letterGrade;
+    uint8_t gradeId = 0;
 };
 
 class GradeCalculator {
@@ -22,6 +299,27 @@ private:
     map<pair<double, double>, string> gradeRanges;
     vector<Student> students;
 
+    static constexpr double SCALE_RESOLUTION = 0.01;
+    vector<string> gradeNames;
+    vector<double> scaleBounds;
+    vector<uint8_t> scaleIds;
+    vector<pair<double, double>> scaleGaps;
+
+    unordered_map<string, uint32_t> subjectIds;
+    vector<string> subjectNames;
+    vector<double> subjectWeightById;
+    vector<vector<double>> scoreColumns;
+    vector<double> rowWeightedSums;
+    vector<double> rowTotalWeights;
+    vector<pair<double, uint32_t>> averageOrder;
+    bool averageOrderStale = false;
+    bool curveApplied = false;
+
+    mutable vector<ScoreStatistics> subjectStats;
+    mutable bool subjectStatsStale = false;
+    mutable ScoreStatistics overallStats;
+    mutable bool overallStatsStale = false;
+
     void fakeClearScreen() const {
         for (int i = 0; i < 50; ++i) {
             cout << endl;
@@ -47,13 +345,320 @@ private:
         return (totalWeight > 0) ? (weightedSum / totalWeight) : 0.0;
     }
 
-    string assignLetterGrade(double average) const {
+    uint32_t internSubject(const string& subject) {
+        auto found = subjectIds.emplace(subject, (uint32_t)subjectNames.size());
+        if (found.second) {
+            subjectNames.push_back(subject);
+            auto weight = subjectWeights.find(subject);
+            subjectWeightById.push_back(weight != subjectWeights.end() ? weight->second : 1.0);
+            scoreColumns.emplace_back(students.size(), numeric_limits<double>::quiet_NaN());
+            subjectStats.emplace_back();
+        }
+        return found.first->second;
+    }
+
+    uint8_t internGradeName(const string& letter) {
+        auto it = find(gradeNames.begin(), gradeNames.end(), letter);
+        if (it != gradeNames.end()) return (uint8_t)(it - gradeNames.begin());
+        if (gradeNames.size() > UINT8_MAX) throw invalid_argument("Too many distinct letter grades");
+        gradeNames.push_back(letter);
+        return (uint8_t)(gradeNames.size() - 1);
+    }
+
+    void compileGradeScale() {
+        const double epsilon = SCALE_RESOLUTION / 2;
+        uint8_t fallback = internGradeName("FF");
+        vector<double> bounds = { -numeric_limits<double>::infinity() };
+        vector<uint8_t> ids = { fallback };
+        vector<pair<double, double>> gaps;
         for (const auto& range : gradeRanges) {
-            if (average >= range.first.first && average <= range.first.second) {
-                return range.second;
+            double lower = range.first.first;
+            double end = range.first.second + SCALE_RESOLUTION;
+            if (bounds.size() > 1) {
+                double previousEnd = bounds.back();
+                if (lower < previousEnd - epsilon) {
+                    throw invalid_argument("Grade range for " + range.second + " overlaps the range below it");
+                }
+                if (lower > previousEnd + epsilon) {
+                    gaps.push_back({ previousEnd, lower });
+                }
+                else {
+                    bounds.pop_back();
+                    ids.pop_back();
+                }
             }
+            bounds.push_back(lower);
+            ids.push_back(internGradeName(range.second));
+            bounds.push_back(end);
+            ids.push_back(fallback);
+        }
+        scaleBounds.swap(bounds);
+        scaleIds.swap(ids);
+        scaleGaps.swap(gaps);
+        reclassifyChangedIntervals(bounds, ids);
+    }
+
+    static uint8_t lookupIn(const vector<double>& bounds, const vector<uint8_t>& ids, double average) {
+        size_t index = (size_t)(upper_bound(bounds.begin(), bounds.end(), average) - bounds.begin());
+        return ids[index - 1];
+    }
+
+    void reclassifyChangedIntervals(const vector<double>& oldBounds, const vector<uint8_t>& oldIds) {
+        if (students.empty() || oldBounds.empty()) return;
+        vector<double> edges;
+        edges.reserve(oldBounds.size() + scaleBounds.size());
+        merge(oldBounds.begin(), oldBounds.end(), scaleBounds.begin(), scaleBounds.end(), back_inserter(edges));
+        edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+        const vector<pair<double, uint32_t>>& order = sortedByAverage();
+        auto rankOf = [&](double value) {
+            return (size_t)(lower_bound(order.begin(), order.end(), make_pair(value, 0u)) - order.begin());
+        };
+        for (size_t e = 0; e < edges.size(); ++e) {
+            if (lookupIn(oldBounds, oldIds, edges[e]) == lookupGradeId(edges[e])) continue;
+            size_t from = rankOf(edges[e]);
+            size_t to = e + 1 < edges.size() ? rankOf(edges[e + 1]) : order.size();
+            for (size_t r = from; r < to; ++r) classifyRow(order[r].second);
+        }
+    }
+
+    const vector<pair<double, uint32_t>>& sortedByAverage() {
+        if (averageOrderStale || averageOrder.size() != students.size()) {
+            averageOrder.resize(students.size());
+            for (size_t i = 0; i < averageOrder.size(); ++i) averageOrder[i] = { students[i].averageGrade, (uint32_t)i };
+            sort(averageOrder.begin(), averageOrder.end());
+            averageOrderStale = false;
+        }
+        return averageOrder;
+    }
+
+    static double weightedAverage(double weightedSum, double totalWeight) {
+        return (totalWeight > 0) ? round(weightedSum / totalWeight * 1e9) / 1e9 : 0.0;
+    }
+
+    void classifyRow(size_t row) {
+        students[row].gradeId = lookupGradeId(students[row].averageGrade);
+        students[row].letterGrade = gradeNames[students[row].gradeId];
+    }
+
+    void refreshRowAverage(size_t row) {
+        students[row].averageGrade = weightedAverage(rowWeightedSums[row], rowTotalWeights[row]);
+        classifyRow(row);
+    }
+
+    template <typename Fn>
+    static void parallelRows(size_t n, Fn fn) {
+        size_t workers = min<size_t>(max(1u, thread::hardware_concurrency()), max<size_t>(1, n / 65536));
+        if (workers == 1) {
+            fn(0, n, 0);
+            return;
+        }
+        vector<thread> pool;
+        for (size_t w = 0; w < workers; ++w) {
+            pool.emplace_back([&, w]() { fn(n * w / workers, n * (w + 1) / workers, w); });
         }
-        return "FF";
+        for (auto& t : pool) t.join();
+    }
+
+    static void selectCuts(vector<double>& values, size_t begin, size_t end, const vector<size_t>& cuts,
+        size_t firstCut, size_t lastCut, int depth) {
+        if (firstCut >= lastCut) return;
+        size_t middle = firstCut + (lastCut - firstCut) / 2;
+        size_t position = cuts[middle];
+        nth_element(values.begin() + begin, values.begin() + position, values.begin() + end);
+        if (depth > 0 && end - begin > 65536) {
+            thread left([&]() { selectCuts(values, begin, position, cuts, firstCut, middle, depth - 1); });
+            selectCuts(values, position + 1, end, cuts, middle + 1, lastCut, depth - 1);
+            left.join();
+        }
+        else {
+            selectCuts(values, begin, position, cuts, firstCut, middle, 0);
+            selectCuts(values, position + 1, end, cuts, middle + 1, lastCut, 0);
+        }
+    }
+
+    vector<double> percentileCutValues() const {
+        size_t n = students.size();
+        vector<double> values(n);
+        parallelRows(n, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) values[i] = students[i].averageGrade;
+        });
+        vector<size_t> cuts;
+        for (size_t k = 1; k < 100; ++k) cuts.push_back(min(n - 1, n * k / 100));
+        vector<size_t> positions(cuts.begin(), cuts.end());
+        positions.erase(unique(positions.begin(), positions.end()), positions.end());
+        int depth = 0;
+        for (unsigned threads = max(1u, thread::hardware_concurrency()); threads > 1; threads /= 2) depth++;
+        selectCuts(values, 0, n, positions, 0, positions.size(), depth);
+        vector<double> cutValues;
+        for (size_t position : cuts) cutValues.push_back(values[position]);
+        return cutValues;
+    }
+
+    static void putString(string& out, const string& value) {
+        uint32_t size = (uint32_t)value.size();
+        out.append(reinterpret_cast<const char*>(&size), sizeof(size)).append(value);
+    }
+
+    template <typename T>
+    static void putValue(string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    static T takeValue(string_view& in) {
+        T value;
+        if (in.size() < sizeof(value)) throw runtime_error("Snapshot config section is truncated");
+        memcpy(&value, in.data(), sizeof(value));
+        in.remove_prefix(sizeof(value));
+        return value;
+    }
+
+    static string takeString(string_view& in) {
+        uint32_t size = takeValue<uint32_t>(in);
+        if (in.size() < size) throw runtime_error("Snapshot config section is truncated");
+        string value(in.substr(0, size));
+        in.remove_prefix(size);
+        return value;
+    }
+
+    template <typename T>
+    static void copySection(string_view section, vector<T>& target, size_t count) {
+        if (section.size() != count * sizeof(T)) throw runtime_error("Snapshot section has the wrong size");
+        target.resize(count);
+        if (count > 0) memcpy(target.data(), section.data(), section.size());
+    }
+
+    void rebuildSubjectStatistics() const {
+        size_t workers = max(1u, thread::hardware_concurrency());
+        subjectStats.assign(scoreColumns.size(), ScoreStatistics());
+        for (size_t j = 0; j < scoreColumns.size(); ++j) {
+            vector<ScoreStatistics> partial(workers);
+            const vector<double>& column = scoreColumns[j];
+            parallelRows(column.size(), [&](size_t begin, size_t end, size_t w) {
+                for (size_t i = begin; i < end; ++i) partial[w].add(column[i]);
+            });
+            for (const auto& stats : partial) subjectStats[j].merge(stats);
+        }
+        subjectStatsStale = false;
+    }
+
+    void restoreRawAverages() {
+        if (!curveApplied) return;
+        parallelRows(students.size(), [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) refreshRowAverage(i);
+        });
+        curveApplied = false;
+        averageOrderStale = true;
+        overallStatsStale = true;
+    }
+
+    uint8_t lookupGradeId(double average) const {
+        const double* base = scaleBounds.data();
+        size_t n = scaleBounds.size();
+        while (n > 1) {
+            size_t half = n / 2;
+            base = (base[half] <= average) ? base + half : base;
+            n -= half;
+        }
+        return scaleIds[(size_t)(base - scaleBounds.data())];
+    }
+
+    struct BatchChunk {
+        vector<string> names;
+        vector<string> surnames;
+        vector<double> scores;
+        vector<double> averages;
+        vector<double> weightedSums;
+        vector<double> totalWeights;
+        vector<uint8_t> gradeIds;
+        string output;
+        vector<ScoreStatistics> subjectStats;
+        ScoreStatistics overallStats;
+        size_t rows = 0;
+        size_t skipped = 0;
+    };
+
+    void gradeBatchChunk(string_view text, char delimiter, const vector<double>& weights, BatchChunk& chunk, bool keepRows) const {
+        const size_t subjectCount = weights.size();
+        vector<double> row(subjectCount);
+        chunk.subjectStats.resize(subjectCount);
+        char number[32];
+        while (!text.empty()) {
+            size_t end = text.find('\n');
+            string_view line = text.substr(0, end);
+            text.remove_prefix(end == string_view::npos ? text.size() : end + 1);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.empty()) continue;
+
+            size_t first = line.find(delimiter);
+            size_t second = first == string_view::npos ? first : line.find(delimiter, first + 1);
+            if (second == string_view::npos && first == string_view::npos) {
+                chunk.skipped++;
+                continue;
+            }
+            string_view name = line.substr(0, first);
+            string_view surname = line.substr(first + 1, second == string_view::npos ? string_view::npos : second - first - 1);
+            string_view cells = second == string_view::npos ? string_view() : line.substr(second + 1);
+
+            double weightedSum = 0.0, totalWeight = 0.0;
+            for (size_t j = 0; j < subjectCount; ++j) {
+                size_t cut = cells.find(delimiter);
+                string_view cell = cells.substr(0, cut);
+                cells.remove_prefix(cut == string_view::npos ? cells.size() : cut + 1);
+                double score;
+                auto parsed = from_chars(cell.data(), cell.data() + cell.size(), score);
+                row[j] = (!cell.empty() && parsed.ec == errc()) ? score : numeric_limits<double>::quiet_NaN();
+                bool present = row[j] == row[j];
+                weightedSum += present ? row[j] * weights[j] : 0.0;
+                totalWeight += present ? weights[j] : 0.0;
+            }
+            double average = weightedAverage(weightedSum, totalWeight);
+            uint8_t gradeId = lookupGradeId(average);
+            for (size_t j = 0; j < subjectCount; ++j) chunk.subjectStats[j].add(row[j]);
+            chunk.overallStats.add(average);
+
+            chunk.output.append(name).append(",").append(surname).append(",");
+            chunk.output.append(number, to_chars(number, number + sizeof(number), average, chars_format::fixed, 2).ptr);
+            chunk.output.append(",").append(gradeNames[gradeId]).append("\n");
+            chunk.rows++;
+            if (keepRows) {
+                chunk.names.emplace_back(name);
+                chunk.surnames.emplace_back(surname);
+                chunk.scores.insert(chunk.scores.end(), row.begin(), row.end());
+                chunk.averages.push_back(average);
+                chunk.weightedSums.push_back(weightedSum);
+                chunk.totalWeights.push_back(totalWeight);
+                chunk.gradeIds.push_back(gradeId);
+            }
+        }
+    }
+
+    void appendBatchChunk(BatchChunk& chunk, const vector<uint32_t>& columnIds) {
+        restoreRawAverages();
+        size_t first = students.size(), rows = chunk.averages.size();
+        for (auto& column : scoreColumns) column.resize(first + rows, numeric_limits<double>::quiet_NaN());
+        for (size_t j = 0; j < columnIds.size(); ++j) {
+            double* column = scoreColumns[columnIds[j]].data() + first;
+            for (size_t r = 0; r < rows; ++r) column[r] = chunk.scores[r * columnIds.size() + j];
+        }
+        rowWeightedSums.insert(rowWeightedSums.end(), chunk.weightedSums.begin(), chunk.weightedSums.end());
+        rowTotalWeights.insert(rowTotalWeights.end(), chunk.totalWeights.begin(), chunk.totalWeights.end());
+        averageOrderStale = true;
+        students.reserve(first + rows);
+        for (size_t r = 0; r < rows; ++r) {
+            Student student;
+            student.name = move(chunk.names[r]);
+            student.surname = move(chunk.surnames[r]);
+            student.averageGrade = chunk.averages[r];
+            student.gradeId = chunk.gradeIds[r];
+            student.letterGrade = gradeNames[student.gradeId];
+            students.push_back(move(student));
+        }
+        if (!subjectStatsStale) {
+            for (size_t j = 0; j < columnIds.size(); ++j) subjectStats[columnIds[j]].merge(chunk.subjectStats[j]);
+        }
+        if (!overallStatsStale) overallStats.merge(chunk.overallStats);
     }
 
 public:
@@ -70,33 +675,257 @@ public:
         gradeRanges[{60.0, 64.99}] = "DD";
         gradeRanges[{50.0, 59.99}] = "FD";
         gradeRanges[{0.0, 49.99}] = "FF";
+        compileGradeScale();
     }
 
     void setSubjectWeight(const string& subject, double weight) {
         subjectWeights[subject] = weight;
+        auto id = subjectIds.find(subject);
+        if (id == subjectIds.end()) return;
+        double delta = weight - subjectWeightById[id->second];
+        subjectWeightById[id->second] = weight;
+        if (delta == 0.0) return;
+        restoreRawAverages();
+        const vector<double>& column = scoreColumns[id->second];
+        for (size_t i = 0; i < column.size(); ++i) {
+            if (column[i] != column[i]) continue;
+            rowWeightedSums[i] += column[i] * delta;
+            rowTotalWeights[i] += delta;
+            refreshRowAverage(i);
+        }
+        averageOrderStale = true;
+        overallStatsStale = true;
     }
 
     void setGradeRange(double lowerBound, double upperBound, const string& letter) {
+        if (upperBound < lowerBound) throw invalid_argument("Grade range upper bound is below its lower bound");
+        auto previous = gradeRanges;
         gradeRanges[{lowerBound, upperBound}] = letter;
+        try {
+            compileGradeScale();
+        }
+        catch (...) {
+            gradeRanges.swap(previous);
+            throw;
+        }
+    }
+
+    void removeGradeRange(double lowerBound, double upperBound) {
+        if (gradeRanges.erase({ lowerBound, upperBound })) compileGradeScale();
+    }
+
+    const vector<pair<double, double>>& gradeScaleGaps() const {
+        return scaleGaps;
     }
 
     void addStudent(const Student& student) {
+        restoreRawAverages();
+        vector<pair<uint32_t, double>> cells;
+        cells.reserve(student.subjectGrades.size());
+        for (const auto& gradePair : student.subjectGrades) {
+            cells.push_back({ internSubject(gradePair.first), gradePair.second });
+        }
+        size_t row = students.size();
+        double weightedSum = 0.0, totalWeight = 0.0;
+        for (auto& column : scoreColumns) column.push_back(numeric_limits<double>::quiet_NaN());
+        for (const auto& cell : cells) {
+            scoreColumns[cell.first][row] = cell.second;
+            if (!subjectStatsStale) subjectStats[cell.first].add(cell.second);
+            weightedSum += cell.second * subjectWeightById[cell.first];
+            totalWeight += subjectWeightById[cell.first];
+        }
+        rowWeightedSums.push_back(weightedSum);
+        rowTotalWeights.push_back(totalWeight);
         students.push_back(student);
+        students.back().subjectGrades.clear();
+        refreshRowAverage(row);
+        if (!overallStatsStale) overallStats.add(students.back().averageGrade);
+        averageOrderStale = true;
+    }
+
+    void recalculateClass() {
+        size_t n = students.size();
+        rowWeightedSums.assign(n, 0.0);
+        rowTotalWeights.assign(n, 0.0);
+        for (size_t j = 0; j < scoreColumns.size(); ++j) {
+            const double weight = subjectWeightById[j];
+            const double* column = scoreColumns[j].data();
+            double* sums = rowWeightedSums.data();
+            double* weights = rowTotalWeights.data();
+            for (size_t i = 0; i < n; ++i) {
+                bool present = column[i] == column[i];
+                sums[i] += present ? column[i] * weight : 0.0;
+                weights[i] += present ? weight : 0.0;
+            }
+        }
+        for (size_t i = 0; i < n; ++i) refreshRowAverage(i);
+        curveApplied = false;
+        averageOrderStale = true;
+        overallStatsStale = true;
+    }
+
+    enum class CurveMethod { ZScore, Shift, Percentile };
+
+    void applyCurve(CurveMethod method, double targetMean, double targetStd) {
+        restoreRawAverages();
+        size_t n = students.size();
+        if (n == 0) return;
+
+        struct Moments {
+            size_t count = 0;
+            double mean = 0.0;
+            double m2 = 0.0;
+        };
+        size_t workers = max(1u, thread::hardware_concurrency());
+        vector<Moments> partial(workers);
+        parallelRows(n, [&](size_t begin, size_t end, size_t w) {
+            Moments m;
+            for (size_t i = begin; i < end; ++i) {
+                double value = students[i].averageGrade;
+                m.count++;
+                double delta = value - m.mean;
+                m.mean += delta / (double)m.count;
+                m.m2 += delta * (value - m.mean);
+            }
+            partial[w] = m;
+        });
+        Moments total;
+        for (const auto& m : partial) {
+            if (m.count == 0) continue;
+            size_t count = total.count + m.count;
+            double delta = m.mean - total.mean;
+            total.m2 += m.m2 + delta * delta * (double)total.count * (double)m.count / (double)count;
+            total.mean += delta * (double)m.count / (double)count;
+            total.count = count;
+        }
+        double stddev = total.count > 1 ? sqrt(total.m2 / (double)(total.count - 1)) : 0.0;
+
+        vector<double> cutValues;
+        if (method == CurveMethod::Percentile) cutValues = percentileCutValues();
+        double scale = (method == CurveMethod::ZScore && stddev > 0) ? targetStd / stddev : 1.0;
+        double offset = targetMean - total.mean * scale;
+
+        parallelRows(n, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                double value = students[i].averageGrade;
+                double curved = (method == CurveMethod::Percentile)
+                    ? 1.0 + (double)(upper_bound(cutValues.begin(), cutValues.end(), value) - cutValues.begin())
+                    : value * scale + offset;
+                students[i].averageGrade = min(100.0, max(0.0, curved));
+                classifyRow(i);
+            }
+        });
+        curveApplied = true;
+        averageOrderStale = true;
+        overallStatsStale = true;
+    }
+
+    void removeCurve() {
+        restoreRawAverages();
+    }
+
+    void curveFromMenu() {
+        if (students.empty()) {
+            cout << "No student data available. Please enter class data first." << endl;
+        }
+        else {
+            int method;
+            cout << "1. Z-score to a target mean and standard deviation" << endl;
+            cout << "2. Shift to a target mean" << endl;
+            cout << "3. Percentile rank (1-100)" << endl;
+            cout << "4. Remove curve" << endl;
+            cout << "Choose a curve: ";
+            cin >> method;
+            double targetMean = 0.0, targetStd = 0.0;
+            if (method == 1 || method == 2) {
+                cout << "Enter the target mean: ";
+                cin >> targetMean;
+            }
+            if (method == 1) {
+                cout << "Enter the target standard deviation: ";
+                cin >> targetStd;
+            }
+            cin.ignore();
+            auto start = chrono::steady_clock::now();
+            switch (method) {
+            case 1: applyCurve(CurveMethod::ZScore, targetMean, targetStd); break;
+            case 2: applyCurve(CurveMethod::Shift, targetMean, 0.0); break;
+            case 3: applyCurve(CurveMethod::Percentile, 0.0, 0.0); break;
+            case 4: removeCurve(); break;
+            default: cout << "Invalid curve." << endl; break;
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (method >= 1 && method <= 4) {
+                cout << "Updated " << students.size() << " students in " << fixed << setprecision(2) << seconds << "s" << endl;
+            }
+        }
+        cout << "\nPress Enter to return to the menu...";
+        cin.get();
+    }
+
+    const ScoreStatistics& classStatistics() const {
+        if (overallStatsStale) {
+            overallStats = ScoreStatistics();
+            for (const auto& student : students) overallStats.add(student.averageGrade);
+            overallStatsStale = false;
+        }
+        return overallStats;
+    }
+
+    const ScoreStatistics* subjectStatistics(const string& subject) const {
+        auto id = subjectIds.find(subject);
+        if (id == subjectIds.end()) return nullptr;
+        if (subjectStatsStale) rebuildSubjectStatistics();
+        return &subjectStats[id->second];
+    }
+
+    void printStatistics(const string& title, const ScoreStatistics& stats) const {
+        cout << "\n" << title << ": " << stats.count << " scores" << endl;
+        if (stats.count == 0) return;
+        cout << fixed << setprecision(2)
+            << "  Mean " << stats.mean << "  Std dev " << stats.standardDeviation()
+            << "  Min " << stats.minimum << "  Max " << stats.maximum << endl
+            << "  P10 " << stats.percentile(10) << "  P25 " << stats.percentile(25)
+            << "  Median " << stats.median() << "  P75 " << stats.percentile(75)
+            << "  P90 " << stats.percentile(90) << endl;
+        uint64_t tallest = *max_element(stats.histogram.begin(), stats.histogram.end());
+        for (int b = 0; b < ScoreStatistics::BINS; ++b) {
+            if (stats.histogram[b] == 0) continue;
+            cout << "  " << setw(6) << right << b * ScoreStatistics::BIN_WIDTH << "-" << setw(6) << left
+                << (b + 1) * ScoreStatistics::BIN_WIDTH << right << " | "
+                << string((size_t)(40 * stats.histogram[b] / tallest), '#') << " " << stats.histogram[b] << endl;
+        }
+    }
+
+    void displayClassStatistics() const {
+        if (students.empty()) {
+            cout << "No student data available." << endl;
+        }
+        else {
+            printStatistics("Overall averages", classStatistics());
+            if (subjectStatsStale) rebuildSubjectStatistics();
+            for (size_t j = 0; j < subjectNames.size(); ++j) printStatistics(subjectNames[j], subjectStats[j]);
+        }
+        cout << "\nPress Enter to return to the menu...";
+        cin.get();
     }
 
     void processStudent(Student& student) {
         student.averageGrade = calculateAverage(student);
-        student.letterGrade = assignLetterGrade(student.averageGrade);
+        student.gradeId = lookupGradeId(student.averageGrade);
+        student.letterGrade = gradeNames[student.gradeId];
     }
 
     void calculateClassAverageForSubject(const string& subject) const {
         double sum = 0.0;
-        int count = 0;
-        for (const auto& student : students) {
-            auto it = student.subjectGrades.find(subject);
-            if (it != student.subjectGrades.end()) {
-                sum += it->second;
-                count++;
+        size_t count = 0;
+        auto id = subjectIds.find(subject);
+        if (id != subjectIds.end()) {
+            const vector<double>& column = scoreColumns[id->second];
+            for (double score : column) {
+                bool present = score == score;
+                sum += present ? score : 0.0;
+                count += present;
             }
         }
         if (count > 0) {
@@ -156,6 +985,332 @@ public:
         cin.get();
     }
 
+    struct BatchSummary {
+        size_t rows = 0;
+        size_t skipped = 0;
+        ScoreStatistics averages;
+    };
+
+    BatchSummary gradeBatchFile(const string& inputFile, const string& outputFile, bool keepInClass) {
+        const size_t waveBytes = 64 << 20;
+        MappedFile file(inputFile);
+        if (!file.isOpen()) throw runtime_error("Cannot read " + inputFile);
+        string_view data = file.contents();
+
+        size_t headerEnd = data.find('\n');
+        string_view header = data.substr(0, headerEnd);
+        if (!header.empty() && header.back() == '\r') header.remove_suffix(1);
+        data.remove_prefix(headerEnd == string_view::npos ? data.size() : headerEnd + 1);
+        char delimiter = header.find('\t') != string_view::npos ? '\t' : ',';
+
+        vector<string> headerSubjects;
+        for (size_t field = 0; !header.empty(); ++field) {
+            size_t cut = header.find(delimiter);
+            if (field >= 2) headerSubjects.emplace_back(header.substr(0, cut));
+            header.remove_prefix(cut == string_view::npos ? header.size() : cut + 1);
+        }
+        vector<double> weights;
+        vector<uint32_t> columnIds;
+        for (const auto& subject : headerSubjects) {
+            auto weight = subjectWeights.find(subject);
+            weights.push_back(weight != subjectWeights.end() ? weight->second : 1.0);
+            if (keepInClass) columnIds.push_back(internSubject(subject));
+        }
+
+        ofstream out(outputFile, ios::binary | ios::trunc);
+        if (!out) throw runtime_error("Cannot write " + outputFile);
+        out << "name,surname,average,letter\n";
+
+        BatchSummary summary;
+        size_t workers = max(1u, thread::hardware_concurrency());
+        while (!data.empty()) {
+            size_t waveEnd = data.size();
+            if (waveEnd > waveBytes) {
+                size_t cut = data.find('\n', waveBytes);
+                waveEnd = (cut == string_view::npos) ? data.size() : cut + 1;
+            }
+            string_view wave = data.substr(0, waveEnd);
+            data.remove_prefix(waveEnd);
+
+            vector<string_view> pieces;
+            while (!wave.empty()) {
+                size_t target = wave.size() / (workers - pieces.size());
+                size_t cut = (pieces.size() + 1 == workers) ? string_view::npos : wave.find('\n', max<size_t>(target, 1) - 1);
+                size_t take = (cut == string_view::npos) ? wave.size() : cut + 1;
+                pieces.push_back(wave.substr(0, take));
+                wave.remove_prefix(take);
+            }
+
+            vector<BatchChunk> chunks(pieces.size());
+            vector<thread> pool;
+            for (size_t c = 0; c < pieces.size(); ++c) {
+                pool.emplace_back([&, c]() { gradeBatchChunk(pieces[c], delimiter, weights, chunks[c], keepInClass); });
+            }
+            for (auto& t : pool) t.join();
+
+            for (auto& chunk : chunks) {
+                out.write(chunk.output.data(), (streamsize)chunk.output.size());
+                summary.rows += chunk.rows;
+                summary.skipped += chunk.skipped;
+                summary.averages.merge(chunk.overallStats);
+                if (keepInClass) appendBatchChunk(chunk, columnIds);
+            }
+        }
+        return summary;
+    }
+
+    void runBatchFromMenu() {
+        string inputFile, outputFile;
+        cout << "Enter the CSV/TSV file to grade (header: name,surname,<subjects...>): ";
+        getline(cin >> ws, inputFile);
+        cout << "Enter the output file for averages and letter grades: ";
+        getline(cin >> ws, outputFile);
+        try {
+            auto start = chrono::steady_clock::now();
+            BatchSummary summary = gradeBatchFile(inputFile, outputFile, true);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "Graded " << summary.rows << " students in " << fixed << setprecision(2) << seconds << "s";
+            if (summary.skipped > 0) cout << " (" << summary.skipped << " malformed lines skipped)";
+            cout << endl;
+        }
+        catch (const exception& ex) {
+            cout << "Error: " << ex.what() << endl;
+        }
+        cout << "\nPress Enter to return to the menu...";
+        cin.get();
+    }
+
+    void saveSnapshot(const string& filename) const {
+        size_t n = students.size();
+        string config;
+        putValue<uint32_t>(config, (uint32_t)subjectWeights.size());
+        for (const auto& weight : subjectWeights) {
+            putString(config, weight.first);
+            putValue<double>(config, weight.second);
+        }
+        putValue<uint32_t>(config, (uint32_t)gradeNames.size());
+        for (const auto& name : gradeNames) putString(config, name);
+        putValue<uint32_t>(config, (uint32_t)gradeRanges.size());
+        for (const auto& range : gradeRanges) {
+            putValue<double>(config, range.first.first);
+            putValue<double>(config, range.first.second);
+            putString(config, range.second);
+        }
+        putValue<uint32_t>(config, (uint32_t)subjectNames.size());
+        for (const auto& subject : subjectNames) putString(config, subject);
+
+        string names;
+        vector<uint64_t> offsets;
+        offsets.reserve(2 * n + 1);
+        for (const auto& student : students) {
+            offsets.push_back(names.size());
+            names.append(student.name);
+            offsets.push_back(names.size());
+            names.append(student.surname);
+        }
+        offsets.push_back(names.size());
+        string nameSection(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        nameSection.append(names);
+
+        vector<double> averages(n);
+        vector<uint8_t> ids(n);
+        for (size_t i = 0; i < n; ++i) {
+            averages[i] = students[i].averageGrade;
+            ids[i] = students[i].gradeId;
+        }
+
+        vector<pair<uint32_t, string_view>> sections = {
+            { SECTION_CONFIG, config },
+            { SECTION_NAMES, nameSection },
+            { SECTION_ROW_SUMS, string_view(reinterpret_cast<const char*>(rowWeightedSums.data()), n * sizeof(double)) },
+            { SECTION_ROW_WEIGHTS, string_view(reinterpret_cast<const char*>(rowTotalWeights.data()), n * sizeof(double)) },
+            { SECTION_AVERAGES, string_view(reinterpret_cast<const char*>(averages.data()), n * sizeof(double)) },
+            { SECTION_GRADE_IDS, string_view(reinterpret_cast<const char*>(ids.data()), n) },
+        };
+        for (size_t j = 0; j < scoreColumns.size(); ++j) {
+            sections.push_back({ SECTION_COLUMN, string_view(reinterpret_cast<const char*>(scoreColumns[j].data()), n * sizeof(double)) });
+        }
+
+        SnapshotHeader header{};
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.studentCount = n;
+        header.subjectCount = (uint32_t)subjectNames.size();
+        header.sectionCount = (uint32_t)sections.size();
+        header.flags = curveApplied ? 1 : 0;
+
+        vector<SnapshotSectionEntry> table(sections.size());
+        uint64_t offset = sizeof(header) + table.size() * sizeof(SnapshotSectionEntry);
+        for (size_t s = 0; s < sections.size(); ++s) {
+            offset = (offset + 7) & ~(uint64_t)7;
+            table[s] = { sections[s].first, 0, offset, sections[s].second.size() };
+            offset += sections[s].second.size();
+        }
+        vector<thread> pool;
+        for (size_t s = 0; s < sections.size(); ++s) {
+            pool.emplace_back([&, s]() { table[s].crc = crc32(sections[s].second.data(), sections[s].second.size()); });
+        }
+        for (auto& t : pool) t.join();
+
+        string temporary = filename + ".tmp";
+        {
+            ofstream out(temporary, ios::binary | ios::trunc);
+            if (!out) throw runtime_error("Cannot write " + temporary);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(table.data()), (streamsize)(table.size() * sizeof(SnapshotSectionEntry)));
+            uint64_t written = sizeof(header) + table.size() * sizeof(SnapshotSectionEntry);
+            const char padding[8] = {};
+            for (size_t s = 0; s < sections.size(); ++s) {
+                out.write(padding, (streamsize)(table[s].offset - written));
+                out.write(sections[s].second.data(), (streamsize)sections[s].second.size());
+                written = table[s].offset + table[s].size;
+            }
+            if (!out.flush()) throw runtime_error("Cannot write " + temporary);
+        }
+#ifdef _WIN32
+        remove(filename.c_str());
+#endif
+        if (rename(temporary.c_str(), filename.c_str()) != 0) throw runtime_error("Cannot replace " + filename);
+    }
+
+    void loadSnapshot(const string& filename) {
+        MappedFile file(filename);
+        if (!file.isOpen()) throw runtime_error("Cannot read " + filename);
+        string_view data = file.contents();
+
+        SnapshotHeader header;
+        if (data.size() < sizeof(header)) throw runtime_error(filename + " is not a grade snapshot");
+        memcpy(&header, data.data(), sizeof(header));
+        if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) throw runtime_error(filename + " is not a grade snapshot");
+        if (header.version != SNAPSHOT_VERSION) throw runtime_error("Unsupported snapshot version " + to_string(header.version));
+        size_t n = (size_t)header.studentCount;
+        if (header.sectionCount != 6 + (uint64_t)header.subjectCount
+            || data.size() < sizeof(header) + (size_t)header.sectionCount * sizeof(SnapshotSectionEntry)) {
+            throw runtime_error("Snapshot section table is corrupt");
+        }
+
+        vector<SnapshotSectionEntry> table(header.sectionCount);
+        memcpy(table.data(), data.data() + sizeof(header), table.size() * sizeof(SnapshotSectionEntry));
+        vector<string_view> sections(table.size());
+        for (size_t s = 0; s < table.size(); ++s) {
+            uint32_t expected = s < 6 ? (uint32_t)(SECTION_CONFIG + s) : (uint32_t)SECTION_COLUMN;
+            if (table[s].id != expected || table[s].offset > data.size() || table[s].size > data.size() - table[s].offset) {
+                throw runtime_error("Snapshot section table is corrupt");
+            }
+            sections[s] = data.substr((size_t)table[s].offset, (size_t)table[s].size);
+        }
+        vector<char> valid(sections.size(), 0);
+        vector<thread> pool;
+        for (size_t s = 0; s < sections.size(); ++s) {
+            pool.emplace_back([&, s]() { valid[s] = crc32(sections[s].data(), sections[s].size()) == table[s].crc; });
+        }
+        for (auto& t : pool) t.join();
+        for (size_t s = 0; s < sections.size(); ++s) {
+            if (!valid[s]) throw runtime_error("Snapshot checksum mismatch in section " + to_string(s));
+        }
+
+        string_view config = sections[0];
+        map<string, double> weights;
+        for (uint32_t count = takeValue<uint32_t>(config); count > 0; --count) {
+            string subject = takeString(config);
+            weights[subject] = takeValue<double>(config);
+        }
+        vector<string> letters;
+        for (uint32_t count = takeValue<uint32_t>(config); count > 0; --count) letters.push_back(takeString(config));
+        map<pair<double, double>, string> ranges;
+        for (uint32_t count = takeValue<uint32_t>(config); count > 0; --count) {
+            double lower = takeValue<double>(config);
+            double upper = takeValue<double>(config);
+            ranges[{ lower, upper }] = takeString(config);
+        }
+        vector<string> subjects;
+        for (uint32_t count = takeValue<uint32_t>(config); count > 0; --count) subjects.push_back(takeString(config));
+        if (subjects.size() != header.subjectCount || letters.size() > UINT8_MAX + 1u) throw runtime_error("Snapshot config section is corrupt");
+
+        vector<uint64_t> offsets;
+        size_t offsetBytes = (2 * n + 1) * sizeof(uint64_t);
+        if (sections[1].size() < offsetBytes) throw runtime_error("Snapshot section has the wrong size");
+        copySection(sections[1].substr(0, offsetBytes), offsets, 2 * n + 1);
+        string_view names = sections[1].substr(offsetBytes);
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            if (offsets[i] > names.size() || (i > 0 && offsets[i] < offsets[i - 1])) throw runtime_error("Snapshot name section is corrupt");
+        }
+        vector<double> sums, totals, averages;
+        vector<uint8_t> ids;
+        copySection(sections[2], sums, n);
+        copySection(sections[3], totals, n);
+        copySection(sections[4], averages, n);
+        copySection(sections[5], ids, n);
+        for (uint8_t id : ids) {
+            if (id >= letters.size()) throw runtime_error("Snapshot grade section is corrupt");
+        }
+        vector<vector<double>> columns(subjects.size());
+        for (size_t j = 0; j < subjects.size(); ++j) copySection(sections[6 + j], columns[j], n);
+
+        GradeCalculator probe;
+        probe.gradeNames = letters;
+        probe.gradeRanges = ranges;
+        try {
+            probe.compileGradeScale();
+        }
+        catch (const invalid_argument&) {
+            throw runtime_error("Snapshot grade scale is invalid");
+        }
+
+        students.clear();
+        gradeRanges.swap(ranges);
+        gradeNames.swap(letters);
+        compileGradeScale();
+
+        subjectWeights.swap(weights);
+        subjectNames.swap(subjects);
+        subjectIds.clear();
+        subjectWeightById.clear();
+        for (size_t j = 0; j < subjectNames.size(); ++j) {
+            subjectIds[subjectNames[j]] = (uint32_t)j;
+            auto weight = subjectWeights.find(subjectNames[j]);
+            subjectWeightById.push_back(weight != subjectWeights.end() ? weight->second : 1.0);
+        }
+        scoreColumns.swap(columns);
+        rowWeightedSums.swap(sums);
+        rowTotalWeights.swap(totals);
+
+        students.resize(n);
+        parallelRows(n, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                Student& student = students[i];
+                student.name.assign(names.data() + offsets[2 * i], (size_t)(offsets[2 * i + 1] - offsets[2 * i]));
+                student.surname.assign(names.data() + offsets[2 * i + 1], (size_t)(offsets[2 * i + 2] - offsets[2 * i + 1]));
+                student.averageGrade = averages[i];
+                student.gradeId = ids[i];
+                student.letterGrade = gradeNames[ids[i]];
+            }
+        });
+        curveApplied = (header.flags & 1) != 0;
+        averageOrderStale = true;
+        overallStatsStale = true;
+        subjectStats.assign(scoreColumns.size(), ScoreStatistics());
+        subjectStatsStale = true;
+    }
+
+    void snapshotFromMenu(bool save) {
+        string filename;
+        cout << "Enter the snapshot file (e.g. class.snap): ";
+        getline(cin >> ws, filename);
+        try {
+            auto start = chrono::steady_clock::now();
+            if (save) saveSnapshot(filename);
+            else loadSnapshot(filename);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << (save ? "Saved " : "Loaded ") << students.size() << " students in " << fixed << setprecision(2) << seconds << "s" << endl;
+        }
+        catch (const exception& ex) {
+            cout << "Error: " << ex.what() << endl;
+        }
+        cout << "\nPress Enter to return to the menu...";
+        cin.get();
+    }
+
     Student getStudentInput() {
         Student student;
         cout << "Enter student name: ";
@@ -195,7 +1350,7 @@ public:
         cin.ignore();
         for (int i = 0; i < numStudents; ++i) {
             cout << "\n--- Entering data for student #" << i + 1 << " ---" << endl;
-            students.push_back(getStudentInput());
+            addStudent(getStudentInput());
         }
         cout << "\nClass data entered successfully. Press Enter to return to the menu...";
         cin.get();
@@ -212,7 +1367,12 @@ public:
             cout << "3. Calculate Class Average for a Subject" << endl;
             cout << "4. Calculate Class Overall Average" << endl;
             cout << "5. Display All Student Results" << endl;
-            cout << "6. Exit" << endl;
+            cout << "6. Batch Grade a CSV/TSV File" << endl;
+            cout << "7. Class Statistics" << endl;
+            cout << "8. Curve Grades" << endl;
+            cout << "9. Save Class Snapshot" << endl;
+            cout << "10. Load Class Snapshot" << endl;
+            cout << "11. Exit" << endl;
             cout << "Enter your choice: ";
             cin >> choice;
             cin.ignore();
@@ -248,6 +1408,21 @@ public:
                 displayAllStudentResults();
                 break;
             case 6:
+                runBatchFromMenu();
+                break;
+            case 7:
+                displayClassStatistics();
+                break;
+            case 8:
+                curveFromMenu();
+                break;
+            case 9:
+                snapshotFromMenu(true);
+                break;
+            case 10:
+                snapshotFromMenu(false);
+                break;
+            case 11:
                 cout << "Exiting the Grade Calculator." << endl;
                 break;
             default:
@@ -255,14 +1430,36 @@ public:
                 cout << "\nPress Enter to return to the menu...";
                 cin.get();
             }
-        } while (choice != 6);
+        } while (choice != 11);
 
         cout << "\nAZD" << endl;
     }
 };
 
-int main() {
+#ifndef GRADE_CALCULATOR_NO_MAIN
+int main(int argc, char* argv[]) {
     GradeCalculator calculator;
+    if (argc > 1 && string(argv[1]) == "--batch") {
+        if (argc != 4) {
+            cerr << "Usage: " << argv[0] << " --batch <scores.csv|tsv> <results.csv>" << endl;
+            return 1;
+        }
+        try {
+            auto start = chrono::steady_clock::now();
+            GradeCalculator::BatchSummary summary = calculator.gradeBatchFile(argv[2], argv[3], false);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "Graded " << summary.rows << " students in " << fixed << setprecision(2) << seconds << "s" << endl;
+            if (summary.skipped > 0) cout << summary.skipped << " malformed lines skipped" << endl;
+            cout << "Average " << summary.averages.mean << ", std dev " << summary.averages.standardDeviation()
+                << ", median " << summary.averages.median() << ", P90 " << summary.averages.percentile(90) << endl;
+        }
+        catch (const exception& ex) {
+            cerr << "Error: " << ex.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
     calculator.run();
     return 0;
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
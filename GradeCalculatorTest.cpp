@@ -0,0 +1,42 @@
+// File: GradeCalculatorTest.cpp
+// Build: g++ -O2 -std=c++17 GradeCalculatorTest.cpp -o grade_test -pthread
+#define GRADE_CALCULATOR_NO_MAIN
+#include "GradeCalculator.cpp"
+
+using namespace std;
+
+int failures = 0;
+
+void check(bool condition, const string& what) {
+    if (condition) return;
+    cerr << "FAILED: " << what << endl;
+    ++failures;
+}
+
+void testPercentileCurveOnSmallClasses() {
+    for (size_t n : { 1, 2, 5, 10, 50, 99, 150 }) {
+        GradeCalculator calculator;
+        for (size_t i = 0; i < n; ++i) {
+            Student student;
+            student.name = "Student" + to_string(i);
+            student.surname = "Test";
+            student.subjectGrades["Midterm"] = 40.0 + 50.0 * (double)i / (double)n;
+            student.subjectGrades["Final"] = 45.0 + 50.0 * (double)i / (double)n;
+            calculator.addStudent(student);
+        }
+        calculator.applyCurve(GradeCalculator::CurveMethod::Percentile, 0.0, 0.0);
+        const ScoreStatistics& stats = calculator.classStatistics();
+        size_t lowestRank = 1;
+        for (size_t k = 1; k < 100; ++k) lowestRank += n * k / 100 == 0 ? 1 : 0;
+        string label = "percentile curve with " + to_string(n) + " students";
+        check(stats.count == n, label + " keeps every student");
+        check(stats.maximum == 100.0, label + " puts the top student at 100");
+        check(stats.minimum == (double)(n == 1 ? 100 : lowestRank), label + " ranks the lowest student correctly");
+    }
+}
+
+int main() {
+    testPercentileCurveOnSmallClasses();
+    if (failures == 0) cout << "All grade calculator tests passed." << endl;
+    return failures == 0 ? 0 : 1;
+}